@@ -0,0 +1,682 @@
+#include "Adaptive.h"
+#include "BasicHuffman.h"
+#include "BlockCodec.h"
+#include "CodeTable.h"
+#include "Huffman.h"
+#include "SpanCodec.h"
+#include "StaticHuffman.h"
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* every heap allocation in the process is counted so benchmarks can report allocations per iteration */
+static std::atomic<std::size_t> allocation_count{ 0 };
+
+/*
+ * The whole operator new/delete family is replaced and funnels through these
+ * two. They stay out of line so the compiler never sees a malloc() from one
+ * operator meet the free() of another and flag the pair as mismatched.
+ */
+[[gnu::noinline]] static void* counted_alloc(std::size_t size, std::size_t alignment) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    size = size ? size : 1;
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+[[gnu::noinline]] static void counted_free(void* p) noexcept {
+    std::free(p);
+}
+
+static void* counted_new(std::size_t size, std::size_t alignment) {
+    if (void* p = counted_alloc(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) {
+    return counted_new(size, 0);
+}
+void* operator new[](std::size_t size) {
+    return counted_new(size, 0);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return counted_new(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return counted_new(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, 0);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, 0);
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    counted_free(p);
+}
+void operator delete[](void* p) noexcept {
+    counted_free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    counted_free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+    counted_free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept {
+    counted_free(p);
+}
+void operator delete[](void* p, std::align_val_t) noexcept {
+    counted_free(p);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    counted_free(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    counted_free(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    counted_free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    counted_free(p);
+}
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    counted_free(p);
+}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    counted_free(p);
+}
+
+namespace {
+
+enum Corpus { random_bytes, english_text, skewed, single_symbol, tiny_messages };
+
+const char* corpus_name(int corpus) {
+    static const char* names[] = { "random", "english", "skewed", "single_symbol", "tiny" };
+    return names[corpus];
+}
+
+std::string make_corpus(int corpus, std::size_t size) {
+    std::mt19937_64 rng(1234);
+    std::string text;
+    text.reserve(size);
+
+    switch (corpus) {
+    case random_bytes:
+        while (text.size() < size) {
+            text.push_back(static_cast<char>(rng()));
+        }
+        break;
+    case english_text: {
+        /* Zipf-distributed words from a small vocabulary */
+        static const char* words[] = { "the",   "of",   "and",   "to",      "a",      "in",   "is",
+                                       "that",  "for",  "it",    "as",      "was",    "with", "be",
+                                       "by",    "on",   "not",   "he",      "this",   "are",  "or",
+                                       "his",   "from", "at",    "which",   "but",    "have", "an",
+                                       "had",   "they", "you",   "were",    "their",  "one",  "all",
+                                       "we",    "can",  "her",   "has",     "there",  "been", "if",
+                                       "more",  "when", "will",  "would",   "who",    "so",   "no",
+                                       "huffman", "compression", "entropy", "symbol", "table" };
+        std::vector<double> weights;
+        for (std::size_t i = 0; i < std::size(words); ++i) {
+            weights.push_back(1.0 / static_cast<double>(i + 1));
+        }
+        std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+        while (text.size() < size) {
+            text += words[pick(rng)];
+            text += rng() % 12 ? " " : ".\n";
+        }
+        break;
+    }
+    case skewed: {
+        std::geometric_distribution<int> pick(0.6);
+        while (text.size() < size) {
+            text.push_back(static_cast<char>('a' + std::min(pick(rng), 40)));
+        }
+        break;
+    }
+    case single_symbol:
+        text.assign(size, 'z');
+        break;
+    case tiny_messages:
+        return make_corpus(english_text, size);
+    }
+
+    text.resize(size);
+    return text;
+}
+
+std::size_t corpus_size(int corpus) {
+    return corpus == tiny_messages ? 48 : std::size_t{ 1 } << 20;
+}
+
+/* table building stages pass 0 bytes: their cost does not scale with the input */
+void report(benchmark::State& state, std::size_t bytes_per_iteration, std::size_t allocations_before) {
+    if (bytes_per_iteration) {
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes_per_iteration));
+    }
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocation_count.load() - allocations_before), benchmark::Counter::kAvgIterations);
+    state.SetLabel(corpus_name(static_cast<int>(state.range(0))));
+}
+
+void BM_CreateFrequencyTable(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(count_frequencies(text.data(), text.size()));
+    }
+    report(state, text.size(), allocations);
+}
+
+void BM_BuildHuffmanTree(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    FrequencyTable frequency_table = count_frequencies(text.data(), text.size());
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        HuffmanTree tree(frequency_table);
+        benchmark::DoNotOptimize(limit_code_lengths(frequency_table, tree.code_lengths(), max_code_length));
+    }
+    report(state, 0, allocations);
+}
+
+void BM_BuildEncodingTable(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    FrequencyTable frequency_table = count_frequencies(text.data(), text.size());
+    CodeLengths lengths = HuffmanTree(frequency_table).code_lengths();
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        std::vector<PrefixCode> codes = assign_canonical_codes(lengths);
+        DecodeTable decode_table(codes);
+        benchmark::DoNotOptimize(decode_table);
+    }
+    report(state, 0, allocations);
+}
+
+void BM_HuffmanConstruct(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        Huffman huffman(text);
+        benchmark::DoNotOptimize(huffman);
+    }
+    report(state, text.size(), allocations);
+}
+
+void BM_HuffmanEncode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    Huffman huffman(text);
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(huffman.encode(text));
+    }
+    report(state, text.size(), allocations);
+}
+
+void BM_HuffmanDecode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    Huffman huffman(text);
+    std::string encoded = huffman.encode(text);
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(huffman.decode(encoded));
+    }
+    report(state, text.size(), allocations);
+}
+
+/* messages share one table trained on a larger sample, the way an RPC layer would use it */
+void BM_CodeTableEncode(benchmark::State& state) {
+    std::string sample = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 16);
+    CodeTable table = CodeTable::train(sample.data(), sample.size(), max_code_length, true);
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    std::string encoded;
+    encoded.reserve(text.size() + 8);
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        encoded.clear();
+        benchmark::DoNotOptimize(table.encode(text.data(), text.size(), encoded));
+    }
+    report(state, text.size(), allocations);
+}
+
+void BM_CodeTableDecode(benchmark::State& state) {
+    std::string sample = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 16);
+    CodeTable table = CodeTable::train(sample.data(), sample.size(), max_code_length, true);
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    std::string encoded;
+    table.encode(text.data(), text.size(), encoded);
+    std::string decoded;
+    decoded.reserve(text.size());
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        decoded.clear();
+        benchmark::DoNotOptimize(table.decode(encoded.data(), encoded.size(), decoded));
+    }
+    report(state, text.size(), allocations);
+}
+
+void BM_BlockEncode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 8 } << 20);
+    BlockCodec codec({ std::size_t{ 1 } << 18, static_cast<unsigned>(state.range(1)) });
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(codec.encode(text));
+    }
+    report(state, text.size(), allocations);
+}
+
+void BM_BlockDecode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 8 } << 20);
+    BlockCodec codec({ std::size_t{ 1 } << 18, static_cast<unsigned>(state.range(1)) });
+    std::string encoded = codec.encode(text);
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(codec.decode(encoded));
+    }
+    report(state, text.size(), allocations);
+}
+
+/* checks every block checksum without decoding; compare with BM_BlockDecode */
+void BM_BlockVerify(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 8 } << 20);
+    BlockCodec codec({ std::size_t{ 1 } << 18, static_cast<unsigned>(state.range(1)) });
+    std::string encoded = codec.encode(text);
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(codec.verify(encoded));
+    }
+    report(state, text.size(), allocations);
+}
+
+/*
+ * Adaptive single-pass coding against the static two-pass mode on the same
+ * 64 KiB granularity the streaming coder uses; both report the compressed
+ * size as a fraction of the input ("ratio").
+ */
+constexpr std::size_t mode_block_size = std::size_t{ 1 } << 16;
+
+std::string encode_static_blocks(const std::string& text, std::vector<std::size_t>& block_sizes) {
+    std::string encoded;
+    for (std::size_t pos = 0; pos < text.size(); pos += mode_block_size) {
+        std::size_t before = encoded.size();
+        encode_block(text.data() + pos, std::min(mode_block_size, text.size() - pos), encoded, max_code_length, 4);
+        block_sizes.push_back(encoded.size() - before);
+    }
+    return encoded;
+}
+
+void report_ratio(benchmark::State& state, std::size_t raw_size, std::size_t encoded_size) {
+    state.counters["ratio"] = static_cast<double>(encoded_size) / static_cast<double>(raw_size);
+}
+
+void BM_StaticModeEncode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    std::vector<std::size_t> block_sizes;
+    std::size_t encoded_size = encode_static_blocks(text, block_sizes).size();
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        block_sizes.clear();
+        benchmark::DoNotOptimize(encode_static_blocks(text, block_sizes));
+    }
+    report(state, text.size(), allocations);
+    report_ratio(state, text.size(), encoded_size);
+}
+
+void BM_StaticModeDecode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    std::vector<std::size_t> block_sizes;
+    std::string encoded = encode_static_blocks(text, block_sizes);
+    std::string decoded(text.size(), '\0');
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        std::size_t in = 0;
+        for (std::size_t i = 0; i < block_sizes.size(); ++i) {
+            std::size_t out = i * mode_block_size;
+            decode_block(encoded.data() + in, block_sizes[i], decoded.data() + out,
+                         std::min(mode_block_size, text.size() - out));
+            in += block_sizes[i];
+        }
+        benchmark::DoNotOptimize(decoded.data());
+    }
+    report(state, text.size(), allocations);
+    report_ratio(state, text.size(), encoded.size());
+}
+
+void BM_AdaptiveEncode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    std::size_t encoded_size = adaptive_encode(text.data(), text.size()).size();
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(adaptive_encode(text.data(), text.size()));
+    }
+    report(state, text.size(), allocations);
+    report_ratio(state, text.size(), encoded_size);
+}
+
+void BM_AdaptiveDecode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    std::string encoded = adaptive_encode(text.data(), text.size());
+    std::string decoded;
+    decoded.reserve(text.size());
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        decoded.clear();
+        benchmark::DoNotOptimize(adaptive_decode(encoded.data(), encoded.size(), decoded));
+    }
+    report(state, text.size(), allocations);
+    report_ratio(state, text.size(), encoded.size());
+}
+
+void mode_corpora(benchmark::internal::Benchmark* bench) {
+    for (int corpus : { random_bytes, english_text, skewed, single_symbol }) {
+        bench->Arg(corpus);
+    }
+}
+
+void BM_DecodeStreams(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    std::string block;
+    encode_block(text.data(), text.size(), block, max_code_length, static_cast<unsigned>(state.range(1)));
+    std::string decoded(text.size(), '\0');
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(decode_block(block.data(), block.size(), decoded.data(), decoded.size()));
+    }
+    report(state, text.size(), allocations);
+}
+
+/* 4 KiB blocks coded one after the other, each with its own table (0) or reusing the previous one (1) */
+std::vector<std::string> encode_block_sequence(const std::string& text, bool reuse) {
+    const std::size_t block_size = std::size_t{ 1 } << 12;
+    std::vector<std::string> blocks;
+    BlockEncodeHistory history;
+    for (std::size_t pos = 0; pos < text.size(); pos += block_size) {
+        std::size_t size = std::min(block_size, text.size() - pos);
+        blocks.emplace_back();
+        if (reuse) {
+            encode_block(text.data() + pos, size, blocks.back(), history, max_code_length, 4);
+        } else {
+            encode_block(text.data() + pos, size, blocks.back(), max_code_length, 4);
+        }
+    }
+    return blocks;
+}
+
+void BM_TableReuseEncode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    std::size_t encoded_size = 0;
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        std::vector<std::string> blocks = encode_block_sequence(text, state.range(1) != 0);
+        encoded_size = 0;
+        for (const std::string& block : blocks) {
+            encoded_size += block.size();
+        }
+    }
+    report(state, text.size(), allocations);
+    state.counters["ratio"] = static_cast<double>(encoded_size) / static_cast<double>(text.size());
+}
+
+void BM_TableReuseDecode(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    std::vector<std::string> blocks = encode_block_sequence(text, state.range(1) != 0);
+    std::string decoded(std::size_t{ 1 } << 12, '\0');
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        BlockDecodeHistory history;
+        for (const std::string& block : blocks) {
+            benchmark::DoNotOptimize(decode_block(block.data(), block.size(), decoded.data(), decoded.size(), history));
+        }
+    }
+    report(state, text.size(), allocations);
+}
+
+/* the kernel benchmarks take the SIMD level as their second argument; levels the CPU lacks run the next one down */
+void BM_HistogramKernel(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    auto level = static_cast<SimdLevel>(state.range(1));
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(count_frequencies(text.data(), text.size(), level));
+    }
+    report(state, text.size(), allocations);
+}
+
+void BM_PackKernel(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), std::size_t{ 1 } << 20);
+    FrequencyTable frequency_table = count_frequencies(text.data(), text.size());
+    FlatEncodeTable table = make_flat_encode_table(HuffmanTree(frequency_table).code_lengths());
+    auto level = static_cast<SimdLevel>(state.range(1));
+    std::string packed;
+    packed.reserve(text.size() + 8);
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        packed.clear();
+        BitWriter writer(packed);
+        pack_symbols(table, text.data(), text.size(), writer, level);
+        benchmark::DoNotOptimize(writer.finish());
+    }
+    report(state, text.size(), allocations);
+}
+
+/* compression between preallocated buffers: what is left to allocate are the code tables */
+void BM_SpanCompress(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    std::vector<std::byte> compressed(max_compressed_size(text.size()));
+    std::size_t written = 0;
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compress(std::as_bytes(std::span(text.data(), text.size())), compressed, written));
+    }
+    report(state, text.size(), allocations);
+}
+
+void BM_SpanDecompress(benchmark::State& state) {
+    std::string text = make_corpus(static_cast<int>(state.range(0)), corpus_size(state.range(0)));
+    std::vector<std::byte> compressed(max_compressed_size(text.size()));
+    std::size_t written = 0;
+    compress(std::as_bytes(std::span(text.data(), text.size())), compressed, written);
+    std::vector<std::byte> decompressed(text.size());
+    std::size_t decompressed_size = 0;
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            decompress(std::span<const std::byte>(compressed.data(), written), decompressed, decompressed_size));
+    }
+    report(state, text.size(), allocations);
+}
+
+/* a fixed letter distribution, compiled into StaticHuffman and trained into a CodeTable for comparison */
+struct LetterProfile {
+    static constexpr FrequencyTable frequencies = [] {
+        FrequencyTable table{};
+        constexpr std::uint64_t letters[26] = { 82, 15, 28, 43, 127, 22, 20, 61, 70, 2,  8,  40, 24,
+                                                67, 75, 19, 1,  60, 63, 91, 28, 10, 24, 2,  20, 1 };
+        for (int i = 0; i < 26; ++i) {
+            table['a' + i] = letters[i];
+        }
+        table[' '] = 180;
+        return table;
+    }();
+};
+
+std::string make_profile_text(std::size_t size) {
+    std::mt19937_64 rng(99);
+    std::discrete_distribution<int> pick(LetterProfile::frequencies.begin(), LetterProfile::frequencies.end());
+    std::string text(size, '\0');
+    for (char& ch : text) {
+        ch = static_cast<char>(pick(rng));
+    }
+    return text;
+}
+
+/* what StaticHuffman saves at startup: building the same tables at runtime */
+void BM_ProfileTableBuild(benchmark::State& state) {
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CodeTable::train(LetterProfile::frequencies, 12));
+    }
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocation_count.load() - allocations), benchmark::Counter::kAvgIterations);
+}
+
+void BM_StaticHuffmanEncode(benchmark::State& state) {
+    std::string text = make_profile_text(std::size_t{ 1 } << 20);
+    std::string encoded;
+    encoded.reserve(StaticHuffman<LetterProfile>::max_encoded_size(text.size()));
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        encoded.clear();
+        benchmark::DoNotOptimize(StaticHuffman<LetterProfile>::encode(text.data(), text.size(), encoded));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocation_count.load() - allocations), benchmark::Counter::kAvgIterations);
+}
+
+void BM_StaticHuffmanDecode(benchmark::State& state) {
+    std::string text = make_profile_text(std::size_t{ 1 } << 20);
+    std::string encoded = StaticHuffman<LetterProfile>::encode(text);
+    std::string decoded;
+    decoded.reserve(text.size());
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        decoded.clear();
+        benchmark::DoNotOptimize(StaticHuffman<LetterProfile>::decode(encoded.data(), encoded.size(), decoded));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocation_count.load() - allocations), benchmark::Counter::kAvgIterations);
+}
+
+/* 16-bit tokens as an LZ or delta stage would emit them: Zipf-distributed over a 4096-token vocabulary */
+std::vector<std::uint16_t> make_tokens(std::size_t count) {
+    std::mt19937_64 rng(1234);
+    std::vector<double> weights;
+    for (int i = 0; i < 4096; ++i) {
+        weights.push_back(1.0 / (i + 1));
+    }
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+    std::vector<std::uint16_t> tokens;
+    for (std::size_t i = 0; i < count; ++i) {
+        tokens.push_back(static_cast<std::uint16_t>(pick(rng) * 13));
+    }
+    return tokens;
+}
+
+void BM_Huffman16Encode(benchmark::State& state) {
+    std::vector<std::uint16_t> tokens = make_tokens(std::size_t{ 1 } << 19);
+    Huffman16 huffman(tokens);
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(huffman.encode(tokens));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * tokens.size() * 2));
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocation_count.load() - allocations), benchmark::Counter::kAvgIterations);
+}
+
+void BM_Huffman16Decode(benchmark::State& state) {
+    std::vector<std::uint16_t> tokens = make_tokens(std::size_t{ 1 } << 19);
+    Huffman16 huffman(tokens);
+    std::string encoded = huffman.encode(tokens);
+    std::vector<std::uint16_t> decoded;
+    decoded.reserve(tokens.size());
+    std::size_t allocations = allocation_count.load();
+    for (auto _ : state) {
+        decoded.clear();
+        benchmark::DoNotOptimize(huffman.decode(encoded.data(), encoded.size(), decoded));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * tokens.size() * 2));
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocation_count.load() - allocations), benchmark::Counter::kAvgIterations);
+}
+
+void corpora(benchmark::internal::Benchmark* bench) {
+    for (int corpus = random_bytes; corpus <= tiny_messages; ++corpus) {
+        bench->Arg(corpus);
+    }
+}
+
+void block_corpora(benchmark::internal::Benchmark* bench) {
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (int corpus : { random_bytes, english_text, skewed }) {
+        for (unsigned threads = 1; threads <= cores; threads *= 2) {
+            bench->Args({ corpus, static_cast<std::int64_t>(threads) });
+        }
+    }
+}
+
+void stream_corpora(benchmark::internal::Benchmark* bench) {
+    for (int corpus : { random_bytes, english_text, skewed }) {
+        for (int streams : { 1, 2, 4, 8 }) {
+            bench->Args({ corpus, streams });
+        }
+    }
+}
+
+void reuse_corpora(benchmark::internal::Benchmark* bench) {
+    for (int corpus : { english_text, skewed }) {
+        for (int reuse : { 0, 1 }) {
+            bench->Args({ corpus, reuse });
+        }
+    }
+}
+
+void kernel_corpora(benchmark::internal::Benchmark* bench) {
+    for (int corpus : { random_bytes, english_text, skewed, single_symbol }) {
+        for (SimdLevel level : { SimdLevel::scalar, SimdLevel::sse42, SimdLevel::avx2 }) {
+            bench->Args({ corpus, static_cast<std::int64_t>(level) });
+        }
+    }
+}
+
+}   // namespace
+
+BENCHMARK(BM_CreateFrequencyTable)->Apply(corpora);
+BENCHMARK(BM_BuildHuffmanTree)->Apply(corpora);
+BENCHMARK(BM_BuildEncodingTable)->Apply(corpora);
+BENCHMARK(BM_HuffmanConstruct)->Apply(corpora);
+BENCHMARK(BM_HuffmanEncode)->Apply(corpora);
+BENCHMARK(BM_HuffmanDecode)->Apply(corpora);
+BENCHMARK(BM_CodeTableEncode)->Apply(corpora);
+BENCHMARK(BM_CodeTableDecode)->Apply(corpora);
+BENCHMARK(BM_StaticModeEncode)->Apply(mode_corpora);
+BENCHMARK(BM_StaticModeDecode)->Apply(mode_corpora);
+BENCHMARK(BM_AdaptiveEncode)->Apply(mode_corpora);
+BENCHMARK(BM_AdaptiveDecode)->Apply(mode_corpora);
+BENCHMARK(BM_SpanCompress)->Apply(corpora);
+BENCHMARK(BM_SpanDecompress)->Apply(corpora);
+BENCHMARK(BM_ProfileTableBuild);
+BENCHMARK(BM_StaticHuffmanEncode);
+BENCHMARK(BM_StaticHuffmanDecode);
+BENCHMARK(BM_Huffman16Encode);
+BENCHMARK(BM_Huffman16Decode);
+BENCHMARK(BM_HistogramKernel)->Apply(kernel_corpora);
+BENCHMARK(BM_PackKernel)->Apply(kernel_corpora);
+BENCHMARK(BM_DecodeStreams)->Apply(stream_corpora);
+BENCHMARK(BM_TableReuseEncode)->Apply(reuse_corpora);
+BENCHMARK(BM_TableReuseDecode)->Apply(reuse_corpora);
+BENCHMARK(BM_BlockEncode)->Apply(block_corpora)->UseRealTime();
+BENCHMARK(BM_BlockDecode)->Apply(block_corpora)->UseRealTime();
+BENCHMARK(BM_BlockVerify)->Apply(block_corpora)->UseRealTime();
+
+BENCHMARK_MAIN();
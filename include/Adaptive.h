@@ -0,0 +1,204 @@
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include "./Block.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct AdaptiveOptions {
+    /* symbols coded with one table before both sides rebuild it */
+    std::size_t rebuild_interval = 4096;
+    unsigned code_length_limit = max_code_length;
+};
+
+/*
+ * Single-pass adaptive coding: encoder and decoder start from the same flat
+ * 8-bit code and count every symbol they code. After each `rebuild_interval`
+ * symbols both rebuild the code from those counts and then halve them, so
+ * older input fades out like a sliding window. The rebuilt code keeps every
+ * byte value encodable, and since both sides rebuild at the same symbol the
+ * stream needs no table headers. The stream is one bitstream plus its trailer
+ * byte (see Block.h).
+ */
+namespace adaptive_detail {
+
+inline FrequencyTable initial_counts() {
+    FrequencyTable counts;
+    counts.fill(1);
+    return counts;
+}
+
+/* the next code for both sides; decays `counts` afterwards */
+inline CodeLengths rebuild(FrequencyTable& counts, unsigned code_length_limit) {
+    FrequencyTable weights;
+    for (std::size_t symbol = 0; symbol < counts.size(); ++symbol) {
+        weights[symbol] = counts[symbol] * 2 + 1;
+        counts[symbol] /= 2;
+    }
+    return train_code_lengths(weights, code_length_limit);
+}
+
+}   // namespace adaptive_detail
+
+/* Output is appended as it completes, a 64-bit word at a time, so nothing is held back but the last few bits */
+class AdaptiveEncoder {
+    /* Outer handles */
+public:
+    explicit AdaptiveEncoder(AdaptiveOptions options = {})
+        : options(options)
+        , writer(pending) {
+        this->options.rebuild_interval = std::max<std::size_t>(this->options.rebuild_interval, 1);
+        table = make_flat_encode_table(flat_lengths());
+    }
+
+    AdaptiveEncoder(const AdaptiveEncoder&) = delete;
+    AdaptiveEncoder& operator=(const AdaptiveEncoder&) = delete;
+
+    void write(const char* data, std::size_t size, std::string& out) {
+        while (size > 0) {
+            std::size_t chunk = std::min(size, options.rebuild_interval - coded);
+            merge_frequencies(counts, count_frequencies(data, chunk));
+            pack_symbols(table, data, chunk, writer);
+            data += chunk;
+            size -= chunk;
+            coded += chunk;
+
+            if (coded == options.rebuild_interval) {
+                table = make_flat_encode_table(adaptive_detail::rebuild(counts, options.code_length_limit));
+                coded = 0;
+            }
+        }
+        out += pending;
+        pending.clear();
+    }
+
+    /* appends the last bits and the trailer byte; the encoder is spent afterwards */
+    void finish(std::string& out) {
+        pending.push_back(static_cast<char>(writer.finish()));
+        out += pending;
+        pending.clear();
+    }
+
+    /* Inner machinery */
+private:
+    AdaptiveOptions options;
+    std::string pending;
+    BitWriter<std::string> writer;
+    FlatEncodeTable table{};
+    FrequencyTable counts = adaptive_detail::initial_counts();
+    std::size_t coded = 0;
+
+    static CodeLengths flat_lengths() {
+        CodeLengths lengths;
+        lengths.fill(8);
+        return lengths;
+    }
+};
+
+/*
+ * Input may arrive in pieces of any size. Symbols are decoded as soon as the
+ * bits that follow them prove they are not trailer or padding: the decoder
+ * lags the input by the trailer byte, the byte before it and one code.
+ */
+class AdaptiveDecoder {
+    /* Outer handles */
+public:
+    explicit AdaptiveDecoder(AdaptiveOptions options = {})
+        : options(options) {
+        this->options.rebuild_interval = std::max<std::size_t>(this->options.rebuild_interval, 1);
+        CodeLengths lengths;
+        lengths.fill(8);
+        use_lengths(lengths);
+    }
+
+    /* appends what can be decoded so far to `out`; false once the input is known to be corrupt */
+    bool write(const char* data, std::size_t size, std::string& out) {
+        pending.append(data, size);
+        if (corrupted || pending.size() < 2) {
+            return !corrupted;
+        }
+
+        decode_pending((pending.size() - 2) * 8, false, out);
+        return !corrupted;
+    }
+
+    /* the input is over: decodes the rest; false unless it ends exactly on the last code */
+    bool finish(std::string& out) {
+        BitstreamView stream;
+        if (corrupted || !parse_bitstream(pending.data(), pending.size(), stream) || stream.bit_count < bit_offset) {
+            corrupted = true;
+            return false;
+        }
+
+        std::uint64_t reached = decode_pending(stream.bit_count, true, out);
+        corrupted = corrupted || reached != stream.bit_count;
+        return !corrupted;
+    }
+
+    /* Inner machinery */
+private:
+    AdaptiveOptions options;
+    std::string pending;
+    unsigned bit_offset = 0;
+    DecodeTable table;
+    unsigned longest = 0;
+    FrequencyTable counts = adaptive_detail::initial_counts();
+    std::size_t coded = 0;
+    bool corrupted = false;
+
+    void use_lengths(const CodeLengths& lengths) {
+        table = DecodeTable(assign_canonical_codes(lengths));
+        longest = *std::max_element(lengths.begin(), lengths.end());
+    }
+
+    /*
+     * Decodes symbols up to bit `end` of `pending`: when `last`, every symbol
+     * that starts before it, otherwise only those whose longest possible code
+     * still ends by it. Drops the consumed bytes and returns the bit position
+     * reached, relative to the pending bytes before the drop.
+     */
+    std::uint64_t decode_pending(std::uint64_t end, bool last, std::string& out) {
+        BitReader reader(pending.data(), pending.size(), end);
+        reader.consume(bit_offset);
+
+        while (last ? reader.consumed() < end : reader.consumed() + longest <= end) {
+            int symbol = table.decode_symbol(reader);
+            if (symbol < 0) {
+                corrupted = true;
+                break;
+            }
+            out.push_back(static_cast<char>(symbol));
+            counts[static_cast<unsigned>(symbol)]++;
+
+            if (++coded == options.rebuild_interval) {
+                use_lengths(adaptive_detail::rebuild(counts, options.code_length_limit));
+                coded = 0;
+            }
+        }
+
+        std::uint64_t reached = reader.consumed();
+        std::size_t dropped = static_cast<std::size_t>(std::min<std::uint64_t>(reached / 8, pending.size()));
+        pending.erase(0, dropped);
+        bit_offset = static_cast<unsigned>(reached - dropped * 8);
+        return reached;
+    }
+};
+
+/* one-shot helpers over whole buffers */
+inline std::string adaptive_encode(const char* data, std::size_t size, AdaptiveOptions options = {}) {
+    std::string out;
+    AdaptiveEncoder encoder(options);
+    encoder.write(data, size, out);
+    encoder.finish(out);
+    return out;
+}
+
+/* false if `data` is not a complete adaptive stream */
+inline bool adaptive_decode(const char* data, std::size_t size, std::string& out, AdaptiveOptions options = {}) {
+    AdaptiveDecoder decoder(options);
+    return decoder.write(data, size, out) && decoder.finish(out);
+}
+
+#endif
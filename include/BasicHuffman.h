@@ -0,0 +1,266 @@
+#ifndef BASIC_HUFFMAN_H
+#define BASIC_HUFFMAN_H
+
+#include "./BitStream.h"
+#include "./ByteOrder.h"
+#include "./CanonicalCode.h"
+#include "./DecodeTable.h"
+#include "./HuffmanTree.h"
+#include "./PackageMerge.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * How symbols of a given type are counted and looked up. Alphabets of up to
+ * 2^16 values use flat arrays indexed by the symbol; wider ones use hash maps,
+ * so memory follows the number of distinct symbols rather than the alphabet.
+ */
+template <typename Symbol>
+struct SymbolTraits {
+    static_assert(std::is_unsigned_v<Symbol> && sizeof(Symbol) <= 4, "symbols are unsigned integers of at most 32 bits");
+
+    static constexpr bool dense = sizeof(Symbol) <= 2;
+    static constexpr std::size_t alphabet_size = dense ? std::size_t{ 1 } << (8 * sizeof(Symbol)) : 0;
+
+    /* symbol -> count, and symbol -> `code | length << 56` (0 when the symbol has no code) */
+    using Counts = std::conditional_t<dense, std::vector<std::uint64_t>, std::unordered_map<Symbol, std::uint64_t>>;
+    using Codes = std::conditional_t<dense, std::vector<std::uint64_t>, std::unordered_map<Symbol, std::uint64_t>>;
+};
+
+/*
+ * Huffman coding over a sequence of integer symbols, e.g. the 16-bit tokens
+ * of an LZ or delta stage. Only the symbols seen in training get codes.
+ *
+ * Output: varint symbol count n, the n present symbols in increasing order as
+ * varint gaps (the first one as is), their code lengths in the CanonicalCode.h
+ * header format, then one bitstream with its trailer byte (see Block.h).
+ * Empty input encodes to "".
+ */
+template <typename Symbol>
+class BasicHuffman {
+    /* Outer handles */
+public:
+    using symbol_type = Symbol;
+    using traits = SymbolTraits<Symbol>;
+
+    /* codes longer than `code_length_limit` bits are avoided by falling back to package-merge */
+    BasicHuffman(const Symbol* data, std::size_t count, unsigned code_length_limit = max_code_length) {
+        typename traits::Counts counts = count_symbols(data, count);
+        if constexpr (traits::dense) {
+            for (std::size_t symbol = 0; symbol < counts.size(); ++symbol) {
+                if (counts[symbol]) {
+                    symbols.push_back(static_cast<Symbol>(symbol));
+                    weights.push_back(counts[symbol]);
+                }
+            }
+        } else {
+            for (const auto& [symbol, frequency] : counts) {
+                symbols.push_back(symbol);
+            }
+            std::sort(symbols.begin(), symbols.end());
+            for (Symbol symbol : symbols) {
+                weights.push_back(counts[symbol]);
+            }
+        }
+
+        use_code(symbols, train_lengths(weights, code_length_limit));
+    }
+
+    explicit BasicHuffman(const std::vector<Symbol>& text, unsigned code_length_limit = max_code_length)
+        : BasicHuffman(text.data(), text.size(), code_length_limit) {
+    }
+
+    /* appends the encoded text to `out`; false, appending nothing, if a symbol has no code */
+    bool encode(const Symbol* data, std::size_t count, std::string& out) const {
+        if (count == 0) {
+            return true;
+        }
+
+        std::size_t start = out.size();
+        write_header(symbols, lengths, out);
+        BitWriter writer(out);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint64_t entry = code_of(data[i]);
+            if (entry == 0) {
+                writer.finish();
+                out.resize(start);
+                return false;
+            }
+            writer.write(entry & ((std::uint64_t{ 1 } << 56) - 1), static_cast<unsigned>(entry >> 56));
+        }
+        out.push_back(static_cast<char>(writer.finish()));
+        return true;
+    }
+
+    std::string encode(const std::vector<Symbol>& text) const {
+        std::string out;
+        encode(text.data(), text.size(), out);
+        return out;
+    }
+
+    /* decodes output of any BasicHuffman<Symbol>; false if it is malformed */
+    bool decode(const char* data, std::size_t size, std::vector<Symbol>& out) const {
+        if (size == 0) {
+            return true;
+        }
+
+        std::vector<Symbol> header_symbols;
+        std::vector<std::uint8_t> header_lengths;
+        std::size_t pos = read_header(data, size, header_symbols, header_lengths);
+        if (pos == 0) {
+            return false;
+        }
+
+        /* text produced by another table needs its own decoder, built from the header alone */
+        bool own = header_symbols == symbols && header_lengths == lengths;
+        DecodeTable foreign_table;
+        if (!own) {
+            foreign_table = DecodeTable(assign_canonical_codes(header_lengths));
+        }
+        const DecodeTable& table = own ? decode_table : foreign_table;
+
+        std::size_t packed_size = size - pos - 1;
+        std::uint8_t last_byte_bits = static_cast<unsigned char>(data[size - 1]);
+        if (packed_size == 0 ? last_byte_bits != 0 : last_byte_bits == 0 || last_byte_bits > 8) {
+            return false;
+        }
+        std::uint64_t bit_count = packed_size ? (packed_size - 1) * 8 + last_byte_bits : 0;
+
+        BitReader reader(data + pos, packed_size, bit_count);
+        while (!reader.exhausted()) {
+            int index = table.decode_symbol(reader);
+            if (index < 0) {
+                return false;
+            }
+            out.push_back(header_symbols[static_cast<std::size_t>(index)]);
+        }
+        return reader.consumed() == bit_count;
+    }
+
+    std::vector<Symbol> decode(const std::string& encoded) const {
+        std::vector<Symbol> out;
+        decode(encoded.data(), encoded.size(), out);
+        return out;
+    }
+
+    /* the symbols that have a code, in increasing order, and their code lengths */
+    const std::vector<Symbol>& get_symbols() const {
+        return symbols;
+    }
+    const std::vector<std::uint8_t>& get_code_lengths() const {
+        return lengths;
+    }
+
+    /* getters for testing purposes */
+    std::uint64_t get_frequency(Symbol symbol) const {
+        auto it = std::lower_bound(symbols.begin(), symbols.end(), symbol);
+        return it != symbols.end() && *it == symbol ? weights[it - symbols.begin()] : 0;
+    }
+    unsigned get_code_length(Symbol symbol) const {
+        return static_cast<unsigned>(code_of(symbol) >> 56);
+    }
+
+    /* Inner machinery */
+private:
+    std::vector<Symbol> symbols;
+    std::vector<std::uint64_t> weights;
+    std::vector<std::uint8_t> lengths;
+    typename traits::Codes codes;
+    DecodeTable decode_table;
+
+    static typename traits::Counts count_symbols(const Symbol* data, std::size_t count) {
+        typename traits::Counts counts;
+        if constexpr (traits::dense) {
+            counts.assign(traits::alphabet_size, 0);
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            counts[data[i]]++;
+        }
+        return counts;
+    }
+
+    /* depths from the merge, or package-merge when they exceed the limit */
+    static std::vector<std::uint8_t> train_lengths(const std::vector<std::uint64_t>& weights, unsigned limit) {
+        std::vector<std::uint32_t> depths = huffman_code_depths(weights);
+        std::uint32_t longest = depths.empty() ? 0 : *std::max_element(depths.begin(), depths.end());
+        if (longest > std::min(limit, max_code_length)) {
+            return package_merge_code_lengths(weights, limit);
+        }
+        return std::vector<std::uint8_t>(depths.begin(), depths.end());
+    }
+
+    void use_code(const std::vector<Symbol>& present, std::vector<std::uint8_t> present_lengths) {
+        lengths = std::move(present_lengths);
+        std::vector<PrefixCode> canonical = assign_canonical_codes(lengths);
+        if constexpr (traits::dense) {
+            codes.assign(traits::alphabet_size, 0);
+        }
+        for (const PrefixCode& code : canonical) {
+            codes[present[code.symbol]] = code.code | std::uint64_t{ code.length } << 56;
+        }
+        decode_table = DecodeTable(canonical);
+    }
+
+    std::uint64_t code_of(Symbol symbol) const {
+        if constexpr (traits::dense) {
+            return codes[symbol];
+        } else {
+            auto it = codes.find(symbol);
+            return it == codes.end() ? 0 : it->second;
+        }
+    }
+
+    static void write_header(const std::vector<Symbol>& present,
+                             const std::vector<std::uint8_t>& present_lengths,
+                             std::string& out) {
+        append_varint(out, present.size());
+        Symbol previous = 0;
+        for (Symbol symbol : present) {
+            append_varint(out, static_cast<std::uint64_t>(symbol - previous));
+            previous = symbol;
+        }
+        write_code_lengths(present_lengths, out);
+    }
+
+    /* returns the number of header bytes consumed, 0 if the header is malformed or nothing follows it */
+    static std::size_t read_header(const char* data,
+                                   std::size_t size,
+                                   std::vector<Symbol>& present,
+                                   std::vector<std::uint8_t>& present_lengths) {
+        std::size_t pos = 0;
+        std::uint64_t count = 0;
+        /* every symbol takes at least one byte, which bounds the allocation below */
+        if (!read_varint(data, size, pos, count) || count == 0 || count > size - pos) {
+            return 0;
+        }
+
+        std::uint64_t symbol = 0;
+        for (std::uint64_t i = 0; i < count; ++i) {
+            std::uint64_t gap = 0;
+            if (!read_varint(data, size, pos, gap) || (i > 0 && gap == 0) ||
+                gap > std::numeric_limits<Symbol>::max() - symbol) {
+                return 0;
+            }
+            symbol += gap;
+            present.push_back(static_cast<Symbol>(symbol));
+        }
+
+        present_lengths.assign(count, 0);
+        std::size_t consumed = read_code_lengths(data + pos, size - pos, present_lengths);
+        if (consumed == 0 || pos + consumed == size) {
+            return 0;
+        }
+        return pos + consumed;
+    }
+};
+
+using Huffman16 = BasicHuffman<std::uint16_t>;
+using Huffman32 = BasicHuffman<std::uint32_t>;
+
+#endif
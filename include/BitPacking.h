@@ -0,0 +1,181 @@
+#ifndef BIT_PACKING_H
+#define BIT_PACKING_H
+
+#include "./BitStream.h"
+#include "./CpuFeatures.h"
+#include "./DecodeTable.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/* the code of every byte value, indexed directly by the byte */
+using EncodeTable = std::array<PrefixCode, 256>;
+
+/* Scalar reference: one table lookup and one writer call per byte */
+template <typename Out>
+void pack_symbols_scalar(const EncodeTable& table, const char* data, std::size_t size, BitWriter<Out>& writer) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        const PrefixCode& code = table[bytes[i]];
+        writer.write(code.code, code.length);
+    }
+}
+
+/*
+ * The same codes packed one 64-bit word per byte value, the code in the low
+ * 56 bits and its length in the top byte: 2 KiB, so the whole table stays in
+ * L1 while the packing loop runs.
+ */
+class FlatEncodeTable {
+public:
+    static constexpr std::uint64_t code_mask = (std::uint64_t{ 1 } << 56) - 1;
+
+    static constexpr std::uint64_t code(std::uint64_t word) {
+        return word & code_mask;
+    }
+    /* 0 for a byte without a code */
+    static constexpr unsigned length(std::uint64_t word) {
+        return static_cast<unsigned>(word >> 56);
+    }
+
+    constexpr FlatEncodeTable() = default;
+
+    constexpr explicit FlatEncodeTable(const EncodeTable& table) {
+        for (std::size_t symbol = 0; symbol < table.size(); ++symbol) {
+            words[symbol] = table[symbol].code | std::uint64_t{ table[symbol].length } << 56;
+            longest_length = std::max(longest_length, table[symbol].length);
+        }
+    }
+
+    constexpr std::uint64_t operator[](unsigned char symbol) const {
+        return words[symbol];
+    }
+    constexpr unsigned longest() const {
+        return longest_length;
+    }
+    /* the 256 words, for kernels that gather from them */
+    constexpr const std::uint64_t* data() const {
+        return words.data();
+    }
+
+private:
+    alignas(64) std::array<std::uint64_t, 256> words{};
+    unsigned longest_length = 0;
+};
+
+/*
+ * Merges the codes of several bytes in a register before each writer call:
+ * four per call when no code is longer than 16 bits, two when none is longer
+ * than 32, one otherwise.
+ */
+template <typename Out>
+void pack_symbols_flat(const FlatEncodeTable& table, const char* data, std::size_t size, BitWriter<Out>& writer) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    constexpr auto code = FlatEncodeTable::code;
+    constexpr auto length = FlatEncodeTable::length;
+
+    std::size_t i = 0;
+    if (table.longest() <= 16) {
+        for (; i + 4 <= size; i += 4) {
+            std::uint64_t w0 = table[bytes[i]];
+            std::uint64_t w1 = table[bytes[i + 1]];
+            std::uint64_t w2 = table[bytes[i + 2]];
+            std::uint64_t w3 = table[bytes[i + 3]];
+            std::uint64_t front = code(w0) << length(w1) | code(w1);
+            std::uint64_t back = code(w2) << length(w3) | code(w3);
+            unsigned back_length = length(w2) + length(w3);
+            writer.write(front << back_length | back, length(w0) + length(w1) + back_length);
+        }
+    } else if (table.longest() <= 32) {
+        for (; i + 2 <= size; i += 2) {
+            std::uint64_t w0 = table[bytes[i]];
+            std::uint64_t w1 = table[bytes[i + 1]];
+            writer.write(code(w0) << length(w1) | code(w1), length(w0) + length(w1));
+        }
+    }
+    for (; i < size; ++i) {
+        std::uint64_t word = table[bytes[i]];
+        writer.write(code(word), length(word));
+    }
+}
+
+#ifdef HUFFMAN_X86
+
+/*
+ * Gathers the codes of four bytes at once from the words of a FlatEncodeTable,
+ * then merges neighbouring codes in the vector register with a
+ * per-lane variable shift. Two codes always fit a 64-bit lane when no code is
+ * longer than 32 bits, and four fit one writer call when none is longer than
+ * 16, so the writer is called once or twice per four bytes instead of four
+ * times. Tables with longer codes take the flat-table path.
+ */
+template <typename Out>
+__attribute__((target("avx2"))) void pack_symbols_avx2(const FlatEncodeTable& table,
+                                                       const char* data,
+                                                       std::size_t size,
+                                                       BitWriter<Out>& writer) {
+    unsigned longest = table.longest();
+    if (longest > 32) {
+        pack_symbols_flat(table, data, size, writer);
+        return;
+    }
+
+    const auto* base = reinterpret_cast<const long long*>(table.data());
+    const __m256i code_mask = _mm256_set1_epi64x((std::int64_t{ 1 } << 56) - 1);
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    bool quads = longest <= 16;
+
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        std::int32_t four;
+        std::memcpy(&four, bytes + i, sizeof(four));
+        __m128i index = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(four));
+        __m256i entries = _mm256_i32gather_epi64(base, index, 8);
+
+        /* lanes 0 and 2 take the code of lanes 1 and 3 behind their own */
+        __m256i codes = _mm256_and_si256(entries, code_mask);
+        __m256i lengths = _mm256_srli_epi64(entries, 56);
+        __m256i next_codes = _mm256_bsrli_epi128(codes, 8);
+        __m256i next_lengths = _mm256_bsrli_epi128(lengths, 8);
+        __m256i pairs = _mm256_or_si256(_mm256_sllv_epi64(codes, next_lengths), next_codes);
+        __m256i pair_lengths = _mm256_add_epi64(lengths, next_lengths);
+
+        auto low = static_cast<std::uint64_t>(_mm256_extract_epi64(pairs, 0));
+        auto high = static_cast<std::uint64_t>(_mm256_extract_epi64(pairs, 2));
+        auto low_length = static_cast<unsigned>(_mm256_extract_epi64(pair_lengths, 0));
+        auto high_length = static_cast<unsigned>(_mm256_extract_epi64(pair_lengths, 2));
+        if (quads) {
+            writer.write(low << high_length | high, low_length + high_length);
+        } else {
+            writer.write(low, low_length);
+            writer.write(high, high_length);
+        }
+    }
+    pack_symbols_flat(table, data + i, size - i, writer);
+}
+
+#endif
+
+/*
+ * Packs the codes of `data` into `writer` with the best kernel up to `level`
+ * that this CPU supports; below AVX2 that is the merged-write flat kernel.
+ * Bytes without a code pack nothing, so callers check can_encode() first.
+ */
+template <typename Out>
+void pack_symbols(const FlatEncodeTable& table,
+                  const char* data,
+                  std::size_t size,
+                  BitWriter<Out>& writer,
+                  SimdLevel level = detected_simd_level()) {
+#ifdef HUFFMAN_X86
+    if (usable_simd_level(level) == SimdLevel::avx2) {
+        pack_symbols_avx2(table, data, size, writer);
+        return;
+    }
+#endif
+    pack_symbols_flat(table, data, size, writer);
+}
+
+#endif
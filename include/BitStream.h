@@ -0,0 +1,149 @@
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Bits are stored MSB-first: the first written bit ends up in the highest bit
+ * of the first byte. Codes are accumulated in a 64-bit register which is
+ * flushed to the byte buffer one whole word at a time. `Out` is std::string or
+ * any buffer with the same push_back/append (e.g. SpanBuffer).
+ */
+template <typename Out = std::string>
+class BitWriter {
+public:
+    explicit BitWriter(Out& out)
+        : out(out) {
+    }
+
+    /* `code` must not have bits set above `length`, `length` <= 64 */
+    void write(std::uint64_t code, unsigned length) {
+        if (length == 0) {
+            return;
+        }
+
+        unsigned free_bits = 64 - count;
+        if (length < free_bits) {
+            acc |= code << (free_bits - length);
+            count += length;
+            return;
+        }
+
+        unsigned rest = length - free_bits;
+        acc |= code >> rest;
+        flush_word();
+        acc = rest ? code << (64 - rest) : 0;
+        count = rest;
+    }
+
+    /* flushes the register and returns how many bits of the last byte are valid (0 if nothing was written) */
+    std::uint8_t finish() {
+        unsigned tail_bytes = (count + 7) / 8;
+        for (unsigned i = 0; i < tail_bytes; ++i) {
+            out.push_back(static_cast<char>(acc >> (56 - 8 * i)));
+        }
+
+        std::uint8_t last_byte_bits = 0;
+        if (count) {
+            last_byte_bits = static_cast<std::uint8_t>(count % 8 ? count % 8 : 8);
+        } else if (words_flushed) {
+            last_byte_bits = 8;
+        }
+
+        acc = 0;
+        count = 0;
+        words_flushed = false;
+        return last_byte_bits;
+    }
+
+private:
+    Out& out;
+    std::uint64_t acc = 0;
+    unsigned count = 0;
+    bool words_flushed = false;
+
+    void flush_word() {
+        char word[8];
+        for (int i = 0; i < 8; ++i) {
+            word[i] = static_cast<char>(acc >> (56 - 8 * i));
+        }
+        out.append(word, 8);
+        words_flushed = true;
+    }
+};
+
+/* Reads bits written by BitWriter; reading past `bit_count` yields zero bits */
+class BitReader {
+public:
+    BitReader(const char* data, std::size_t size, std::uint64_t bit_count)
+        : data(reinterpret_cast<const unsigned char*>(data))
+        , size(size)
+        , bit_count(bit_count) {
+        refill();
+    }
+
+    /* `n` must be <= 56 */
+    std::uint64_t peek(unsigned n) {
+        if (count < n) {
+            refill();
+        }
+        return n ? acc >> (64 - n) : 0;
+    }
+
+    void consume(unsigned n) {
+        acc = n < 64 ? acc << n : 0;
+        count -= n;
+        position += n;
+    }
+
+    std::uint64_t read(unsigned n) {
+        std::uint64_t bits = peek(n);
+        consume(n);
+        return bits;
+    }
+
+    std::uint64_t consumed() const {
+        return position;
+    }
+    bool exhausted() const {
+        return position >= bit_count;
+    }
+    std::uint64_t bits_remaining() const {
+        return exhausted() ? 0 : bit_count - position;
+    }
+
+private:
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t next_byte = 0;
+    std::uint64_t bit_count;
+    std::uint64_t position = 0;
+    std::uint64_t acc = 0;
+    unsigned count = 0;
+
+    /* tops the register up to at least 56 valid bits */
+    void refill() {
+        if (next_byte + 8 <= size) {
+            std::uint64_t word = 0;
+            for (int i = 0; i < 8; ++i) {
+                word = (word << 8) | data[next_byte + i];
+            }
+            acc |= word >> count;
+            unsigned taken = (63 - count) / 8;
+            next_byte += taken;
+            count += taken * 8;
+            return;
+        }
+
+        while (count <= 56) {
+            std::uint64_t byte = next_byte < size ? data[next_byte] : 0;
+            ++next_byte;
+            acc |= byte << (56 - count);
+            count += 8;
+        }
+    }
+};
+
+#endif
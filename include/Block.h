@@ -0,0 +1,570 @@
+#ifndef BLOCK_H
+#define BLOCK_H
+
+#include "./BitPacking.h"
+#include "./BitStream.h"
+#include "./ByteOrder.h"
+#include "./CanonicalCode.h"
+#include "./DecodeTable.h"
+#include "./Histogram.h"
+#include "./HuffmanTree.h"
+#include "./PackageMerge.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+inline constexpr unsigned max_block_streams = 16;
+
+/*
+ * Blocks that Huffman coding would not shrink are kept in one of two other
+ * forms, tagged by a first byte no code length header can start with (a
+ * repeat item needs a previous length):
+ *   stored:  0x7F, then the raw bytes
+ *   run:     0x7E, the byte, then the varint number of repeats
+ * In a sequence of dependent blocks (a stream) a third form refers back:
+ *   repeat:  0x7D, then a Huffman block without its code length header,
+ *            coded with the table of the last Huffman or repeat block
+ */
+inline constexpr unsigned char stored_block_tag = 0x7F;
+inline constexpr unsigned char run_block_tag = 0x7E;
+inline constexpr unsigned char repeat_block_tag = 0x7D;
+
+enum class BlockKind { huffman, stored, run, repeat };
+
+inline BlockKind block_kind(const char* data, std::size_t size) {
+    if (size > 0 && static_cast<unsigned char>(data[0]) == stored_block_tag) {
+        return BlockKind::stored;
+    }
+    if (size > 0 && static_cast<unsigned char>(data[0]) == run_block_tag) {
+        return BlockKind::run;
+    }
+    if (size > 0 && static_cast<unsigned char>(data[0]) == repeat_block_tag) {
+        return BlockKind::repeat;
+    }
+    return BlockKind::huffman;
+}
+
+/* false unless `data` is a run block; fills the repeated byte and the repeat count */
+inline bool parse_run_block(const char* data, std::size_t size, char& byte, std::uint64_t& count) {
+    std::size_t pos = 2;
+    if (block_kind(data, size) != BlockKind::run || size < 3 || !read_varint(data, size, pos, count)) {
+        return false;
+    }
+    byte = data[1];
+    return pos == size;
+}
+
+/* the most bytes a block of `size` encoded bytes can decode to, to bound allocations before decoding */
+inline std::uint64_t max_decoded_block_size(const char* data, std::size_t size) {
+    char byte;
+    std::uint64_t count = 0;
+    switch (block_kind(data, size)) {
+    case BlockKind::stored:
+        return size - 1;
+    case BlockKind::run:
+        return parse_run_block(data, size, byte, count) ? count : 0;
+    default:
+        /* every symbol takes at least one bit */
+        return std::uint64_t{ size } * 8;
+    }
+}
+
+/* one packed bitstream followed by a trailer byte with the number of valid bits in its last byte */
+struct BitstreamView {
+    const char* packed = nullptr;
+    std::size_t packed_size = 0;
+    std::uint64_t bit_count = 0;
+};
+
+/*
+ * A block is self-contained:
+ *   code length header
+ *   u8 stream count k
+ *   jump table: u32 (little-endian) size of each of the first k - 1 streams
+ *   k bitstreams, each with its trailer byte
+ * Stream i carries the i-th of k equal contiguous segments of the input
+ * (the last one possibly shorter), so a decoder can run all k in lockstep.
+ */
+struct BlockView {
+    CodeLengths lengths{};
+    unsigned stream_count = 0;
+    std::array<BitstreamView, max_block_streams> streams{};
+};
+
+/*
+ * Upper bound on the encoded size of a `raw_size` byte block. The optimal
+ * (possibly length-limited) code never costs more than the fixed 8-bit code,
+ * so the packed bits never outgrow the input; the header takes at most one
+ * byte per symbol, then come the stream count, jump table and trailers.
+ */
+inline constexpr std::size_t max_encoded_block_size(std::size_t raw_size) {
+    return 256 + 1 + 5 * max_block_streams + raw_size;
+}
+
+/* first symbol of stream `stream` when `raw_size` symbols are split over `stream_count` streams */
+inline std::size_t stream_segment_begin(std::size_t raw_size, unsigned stream_count, unsigned stream) {
+    std::size_t segment = (raw_size + stream_count - 1) / stream_count;
+    return std::min(raw_size, segment * stream);
+}
+
+/* reads one bitstream spanning all of `data`, its trailer byte last; false if the trailer is inconsistent */
+inline bool parse_bitstream(const char* data, std::size_t size, BitstreamView& stream) {
+    if (size == 0) {
+        return false;
+    }
+
+    std::uint8_t last_byte_bits = static_cast<unsigned char>(data[size - 1]);
+    stream.packed = data;
+    stream.packed_size = size - 1;
+    if (stream.packed_size == 0 ? last_byte_bits != 0 : last_byte_bits == 0 || last_byte_bits > 8) {
+        return false;
+    }
+    stream.bit_count = stream.packed_size ? (stream.packed_size - 1) * 8 + last_byte_bits : 0;
+    return true;
+}
+
+/* the stream count, jump table and bitstreams from `pos` to the end of the block */
+inline bool parse_block_streams(const char* data, std::size_t size, std::size_t pos, BlockView& block) {
+    if (pos >= size) {
+        return false;
+    }
+
+    block.stream_count = static_cast<unsigned char>(data[pos++]);
+    if (block.stream_count == 0 || block.stream_count > max_block_streams ||
+        size - pos < 4 * std::size_t{ block.stream_count - 1 }) {
+        return false;
+    }
+
+    std::size_t jump_table = pos;
+    pos += 4 * std::size_t{ block.stream_count - 1 };
+
+    for (unsigned i = 0; i < block.stream_count; ++i) {
+        std::size_t stream_size =
+            i + 1 < block.stream_count ? load_le32(data + jump_table + 4 * i) : size - pos;
+        if (stream_size > size - pos || !parse_bitstream(data + pos, stream_size, block.streams[i])) {
+            return false;
+        }
+        pos += stream_size;
+    }
+    return pos == size;
+}
+
+/* false if the block is truncated or its header is malformed */
+inline bool parse_block(const char* data, std::size_t size, BlockView& block) {
+    std::size_t pos = read_code_lengths(data, size, block.lengths);
+    return pos != 0 && parse_block_streams(data, size, pos, block);
+}
+
+/* a repeat block has no header: `block.lengths` is left for the caller to fill from the previous block */
+inline bool parse_repeat_block(const char* data, std::size_t size, BlockView& block) {
+    return block_kind(data, size) == BlockKind::repeat && parse_block_streams(data, size, 1, block);
+}
+
+/* optimal code lengths for `frequency_table`, none longer than `code_length_limit` */
+inline CodeLengths train_code_lengths(const FrequencyTable& frequency_table, unsigned code_length_limit) {
+    return limit_code_lengths(frequency_table, HuffmanTree(frequency_table).code_lengths(), code_length_limit);
+}
+
+/* the encode table of a canonical code; absent symbols have length 0 */
+inline EncodeTable make_encode_table(const CodeLengths& lengths) {
+    EncodeTable table{};
+    for (const PrefixCode& code : assign_canonical_codes(lengths)) {
+        table[code.symbol] = code;
+    }
+    return table;
+}
+
+/* the same table in the one-word-per-byte form every packing kernel reads */
+inline FlatEncodeTable make_flat_encode_table(const CodeLengths& lengths) {
+    return FlatEncodeTable(make_encode_table(lengths));
+}
+
+/* packs `data` into one bitstream plus its trailer byte */
+template <typename Out>
+void write_bitstream(const FlatEncodeTable& table, const char* data, std::size_t size, Out& out) {
+    BitWriter writer(out);
+    pack_symbols(table, data, size, writer);
+    out.push_back(static_cast<char>(writer.finish()));
+}
+
+/* Shannon entropy of the whole input in bits: no prefix code of it can be shorter */
+inline double entropy_bits(const FrequencyTable& frequency_table, std::size_t size) {
+    double bits = 0;
+    for (std::uint64_t frequency : frequency_table) {
+        if (frequency) {
+            bits += static_cast<double>(frequency) * std::log2(static_cast<double>(size) / static_cast<double>(frequency));
+        }
+    }
+    return bits;
+}
+
+/*
+ * Predicted Huffman block size from the histogram alone: the entropy plus the
+ * header at one byte per present symbol, the stream count, the jump table and
+ * the trailers.
+ */
+inline std::size_t predicted_block_size(const FrequencyTable& frequency_table, std::size_t size, unsigned stream_count) {
+    return static_cast<std::size_t>(std::ceil(entropy_bits(frequency_table, size) / 8)) +
+           count_symbols(frequency_table) + 1 + 5 * std::size_t{ stream_count };
+}
+
+template <typename Out>
+void encode_stored_block(const char* data, std::size_t size, Out& out) {
+    out.push_back(static_cast<char>(stored_block_tag));
+    out.append(data, size);
+}
+
+/* the stream count, jump table and bitstreams that follow a block's header */
+template <typename Out>
+void write_block_streams(const FlatEncodeTable& table, const char* data, std::size_t size, Out& out, unsigned stream_count) {
+    out.push_back(static_cast<char>(stream_count));
+    std::size_t jump_table = out.size();
+    out.append(4 * std::size_t{ stream_count - 1 }, '\0');
+
+    for (unsigned i = 0; i < stream_count; ++i) {
+        std::size_t begin = stream_segment_begin(size, stream_count, i);
+        std::size_t end = stream_segment_begin(size, stream_count, i + 1);
+        std::size_t stream_start = out.size();
+        write_bitstream(table, data + begin, end - begin, out);
+
+        if (i + 1 < stream_count) {
+            store_le32(out.data() + jump_table + 4 * i, static_cast<std::uint32_t>(out.size() - stream_start));
+        }
+    }
+}
+
+/*
+ * encode_block() once the histogram is counted and `stream_count` clamped.
+ * Returns true if a Huffman block was written, its code then being left in
+ * `lengths` and `table`; both are untouched otherwise.
+ */
+template <typename Out>
+bool encode_counted_block(const FrequencyTable& frequency_table,
+                          const char* data,
+                          std::size_t size,
+                          Out& out,
+                          unsigned code_length_limit,
+                          unsigned stream_count,
+                          CodeLengths& lengths,
+                          FlatEncodeTable& table) {
+    std::size_t block_start = out.size();
+    if (count_symbols(frequency_table) == 1) {
+        out.push_back(static_cast<char>(run_block_tag));
+        out.push_back(data[0]);
+        append_varint(out, size);
+        /* a couple of bytes are cheaper stored */
+        if (out.size() - block_start > size + 1) {
+            out.resize(block_start);
+            encode_stored_block(data, size, out);
+        }
+        return false;
+    }
+    if (predicted_block_size(frequency_table, size, stream_count) >= size + 1) {
+        encode_stored_block(data, size, out);
+        return false;
+    }
+
+    CodeLengths trained = train_code_lengths(frequency_table, code_length_limit);
+    std::uint64_t coded_bits = 0;
+    for (std::size_t symbol = 0; symbol < trained.size(); ++symbol) {
+        coded_bits += frequency_table[symbol] * trained[symbol];
+    }
+
+    write_code_lengths(trained, out);
+    /* per stream: a jump table entry, a trailer and less than one byte of rounding */
+    std::size_t coded_bound = out.size() - block_start + 1 + 6 * std::size_t{ stream_count } + (coded_bits + 7) / 8;
+    if (coded_bound >= size + 1) {
+        out.resize(block_start);
+        encode_stored_block(data, size, out);
+        return false;
+    }
+
+    lengths = trained;
+    table = make_flat_encode_table(trained);
+    write_block_streams(table, data, size, out, stream_count);
+    return true;
+}
+
+/*
+ * Learns a table from `data` alone and appends the block to `out`; empty
+ * input appends nothing. `stream_count` is clamped to [1, max_block_streams].
+ * Input of a single byte value becomes a run block (unless it is shorter). When the prediction from
+ * the histogram says coding would not beat a stored block, the stored block
+ * is written without building the code at all; a code that turns out to lose
+ * once its exact size is known is dropped before any bit is packed. The
+ * block is therefore never longer than `size` + 1 bytes.
+ */
+template <typename Out>
+void encode_block(const char* data,
+                  std::size_t size,
+                  Out& out,
+                  unsigned code_length_limit = max_code_length,
+                  unsigned stream_count = 1) {
+    if (size == 0) {
+        return;
+    }
+    CodeLengths lengths;
+    FlatEncodeTable table;
+    encode_counted_block(count_frequencies(data, size),
+                         data,
+                         size,
+                         out,
+                         code_length_limit,
+                         std::clamp(stream_count, 1u, max_block_streams),
+                         lengths,
+                         table);
+}
+
+/*
+ * The code of the last Huffman block an encoder wrote into a sequence of
+ * dependent blocks. A block whose histogram the code still suits is written
+ * as a repeat block: no tree is built and no header is sent.
+ */
+struct BlockEncodeHistory {
+    /* reuse while the old code is estimated to cost at most this fraction of the block more than a new one */
+    double max_reuse_loss = 0.01;
+    CodeLengths lengths{};
+    FlatEncodeTable table{};
+    bool valid = false;
+};
+
+/*
+ * encode_block() for the next block of a sequence. The histogram prices the
+ * block under the previous code exactly and under a new code at the entropy
+ * plus the header a new table needs; the new code's real cost can only be
+ * higher, so the estimate leans toward building a table. A previous code
+ * that lacks a symbol of the block is never reused.
+ */
+template <typename Out>
+void encode_block(const char* data,
+                  std::size_t size,
+                  Out& out,
+                  BlockEncodeHistory& history,
+                  unsigned code_length_limit = max_code_length,
+                  unsigned stream_count = 1) {
+    if (size == 0) {
+        return;
+    }
+    stream_count = std::clamp(stream_count, 1u, max_block_streams);
+
+    FrequencyTable frequency_table = count_frequencies(data, size);
+    if (history.valid && count_symbols(frequency_table) > 1) {
+        std::uint64_t reused_bits = 0;
+        bool covered = true;
+        for (std::size_t symbol = 0; symbol < frequency_table.size(); ++symbol) {
+            covered &= frequency_table[symbol] == 0 || history.lengths[symbol] != 0;
+            reused_bits += frequency_table[symbol] * history.lengths[symbol];
+        }
+
+        /* the tag and stream count, then a jump table entry and a trailer per stream */
+        std::size_t reused_size = 2 + 5 * std::size_t{ stream_count } + (reused_bits + 7) / 8;
+        double loss = static_cast<double>(reused_size) -
+                      static_cast<double>(predicted_block_size(frequency_table, size, stream_count));
+        /* a stream's rounding byte is left out above; the bound keeps the block within `size` + 1 bytes */
+        if (covered && reused_size + stream_count < size + 1 &&
+            loss <= history.max_reuse_loss * static_cast<double>(size)) {
+            out.push_back(static_cast<char>(repeat_block_tag));
+            write_block_streams(history.table, data, size, out, stream_count);
+            return;
+        }
+    }
+
+    if (encode_counted_block(
+            frequency_table, data, size, out, code_length_limit, stream_count, history.lengths, history.table)) {
+        history.valid = true;
+    }
+}
+
+/* decodes every stream to its end, one after the other; false unless each one ends on a code boundary */
+inline bool decode_block(const char* data, std::size_t size, std::string& out) {
+    char byte;
+    std::uint64_t count = 0;
+    switch (block_kind(data, size)) {
+    case BlockKind::stored:
+        out.append(data + 1, size - 1);
+        return true;
+    case BlockKind::run:
+        if (!parse_run_block(data, size, byte, count)) {
+            return false;
+        }
+        out.append(static_cast<std::size_t>(count), byte);
+        return true;
+    default:
+        break;
+    }
+
+    BlockView block;
+    if (!parse_block(data, size, block)) {
+        return false;
+    }
+
+    DecodeTable table(assign_canonical_codes(block.lengths));
+    if (table.empty()) {
+        return false;
+    }
+    for (unsigned i = 0; i < block.stream_count; ++i) {
+        const BitstreamView& stream = block.streams[i];
+        BitReader reader(stream.packed, stream.packed_size, stream.bit_count);
+        table.decode(reader, out);
+        if (reader.consumed() != stream.bit_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Decodes N streams in lockstep: the N readers have no data dependency on one
+ * another, so their table lookups and shifts overlap in the pipeline instead
+ * of waiting on a single bit position.
+ */
+template <unsigned N>
+bool decode_streams_interleaved(const DecodeTable& table, const BlockView& block, char* out, std::size_t raw_size) {
+    auto readers = [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<BitReader, N>{ BitReader(
+            block.streams[I].packed, block.streams[I].packed_size, block.streams[I].bit_count)... };
+    }(std::make_index_sequence<N>{});
+
+    std::array<char*, N> outs;
+    std::array<std::size_t, N> counts;
+    for (unsigned i = 0; i < N; ++i) {
+        std::size_t begin = stream_segment_begin(raw_size, N, i);
+        outs[i] = out + begin;
+        counts[i] = stream_segment_begin(raw_size, N, i + 1) - begin;
+    }
+
+    /* segment lengths never increase, so the last one bounds the lockstep part */
+    std::size_t common = counts[N - 1];
+    int invalid = 0;
+    for (std::size_t j = 0; j < common; ++j) {
+        for (unsigned i = 0; i < N; ++i) {
+            int symbol = table.decode_symbol(readers[i]);
+            invalid |= symbol;
+            outs[i][j] = static_cast<char>(symbol);
+        }
+    }
+    for (unsigned i = 0; i + 1 < N; ++i) {
+        for (std::size_t j = common; j < counts[i]; ++j) {
+            int symbol = table.decode_symbol(readers[i]);
+            invalid |= symbol;
+            outs[i][j] = static_cast<char>(symbol);
+        }
+    }
+
+    for (unsigned i = 0; i < N; ++i) {
+        if (readers[i].consumed() != block.streams[i].bit_count) {
+            return false;
+        }
+    }
+    return invalid >= 0;
+}
+
+/* decodes every stream of a parsed block into `out`, the interleaved way for 2, 4 and 8 streams */
+inline bool decode_block_streams(const DecodeTable& table, const BlockView& block, char* out, std::size_t raw_size) {
+    switch (block.stream_count) {
+    case 2:
+        return decode_streams_interleaved<2>(table, block, out, raw_size);
+    case 4:
+        return decode_streams_interleaved<4>(table, block, out, raw_size);
+    case 8:
+        return decode_streams_interleaved<8>(table, block, out, raw_size);
+    default:
+        break;
+    }
+
+    for (unsigned i = 0; i < block.stream_count; ++i) {
+        std::size_t begin = stream_segment_begin(raw_size, block.stream_count, i);
+        std::size_t count = stream_segment_begin(raw_size, block.stream_count, i + 1) - begin;
+        const BitstreamView& stream = block.streams[i];
+        BitReader reader(stream.packed, stream.packed_size, stream.bit_count);
+
+        if (table.decode(reader, out + begin, count) != count || reader.consumed() != stream.bit_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Decodes into a caller-sized buffer; false unless exactly `raw_size` symbols
+ * come out. Blocks are decoded on their own here, so a repeat block fails.
+ */
+inline bool decode_block(const char* data, std::size_t size, char* out, std::size_t raw_size) {
+    char byte;
+    std::uint64_t count = 0;
+    switch (block_kind(data, size)) {
+    case BlockKind::stored:
+        if (size - 1 != raw_size) {
+            return false;
+        }
+        std::memcpy(out, data + 1, raw_size);
+        return true;
+    case BlockKind::run:
+        if (!parse_run_block(data, size, byte, count) || count != raw_size) {
+            return false;
+        }
+        std::memset(out, byte, raw_size);
+        return true;
+    default:
+        break;
+    }
+
+    BlockView block;
+    if (!parse_block(data, size, block)) {
+        return false;
+    }
+
+    DecodeTable table(assign_canonical_codes(block.lengths));
+    return !table.empty() && decode_block_streams(table, block, out, raw_size);
+}
+
+/*
+ * The lookup table of the last Huffman or repeat block a decoder went
+ * through in a sequence of dependent blocks, mirroring BlockEncodeHistory.
+ */
+struct BlockDecodeHistory {
+    CodeLengths lengths{};
+    DecodeTable table;
+    bool valid = false;
+};
+
+/*
+ * decode_block() for the next block of a sequence: a repeat block decodes
+ * with the table already built, and so does a Huffman block whose header
+ * sends the same code again. A repeat block with no table before it is
+ * malformed.
+ */
+inline bool decode_block(const char* data, std::size_t size, char* out, std::size_t raw_size, BlockDecodeHistory& history) {
+    BlockView block;
+    switch (block_kind(data, size)) {
+    case BlockKind::stored:
+    case BlockKind::run:
+        return decode_block(data, size, out, raw_size);
+    case BlockKind::repeat:
+        if (!history.valid || !parse_repeat_block(data, size, block)) {
+            return false;
+        }
+        break;
+    case BlockKind::huffman:
+        if (!parse_block(data, size, block)) {
+            return false;
+        }
+        if (!history.valid || block.lengths != history.lengths) {
+            history.table = DecodeTable(assign_canonical_codes(block.lengths));
+            history.lengths = block.lengths;
+            history.valid = !history.table.empty();
+            if (!history.valid) {
+                return false;
+            }
+        }
+        break;
+    }
+    return decode_block_streams(history.table, block, out, raw_size);
+}
+
+#endif
@@ -0,0 +1,330 @@
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include "./Block.h"
+#include "./ByteOrder.h"
+#include "./Checksum.h"
+#include "./ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/* the largest block a container may hold, so no block makes a decoder allocate more than this */
+inline constexpr std::size_t max_container_block_size = std::size_t{ 1 } << 26;
+
+struct BlockOptions {
+    /* clamped to max_container_block_size */
+    std::size_t block_size = std::size_t{ 1 } << 20;
+    unsigned threads = std::thread::hardware_concurrency();
+    unsigned code_length_limit = max_code_length;
+    /* interleaved bitstreams per block, decoded in lockstep */
+    unsigned streams = 4;
+    /* stored per block and over the index; decoding follows whatever the container says */
+    Checksum checksum = Checksum::crc32c;
+};
+
+/* where a block sits in the container and which slice of the original input it holds */
+struct BlockIndexEntry {
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint64_t raw_offset;
+    std::uint64_t raw_size;
+    std::uint32_t checksum;
+};
+
+/*
+ * Splits the input into fixed-size blocks, each with its own histogram and
+ * canonical table, and encodes them concurrently. A footer index makes every
+ * block reachable without decoding the ones before it.
+ *
+ * Container layout (little-endian):
+ *   header: magic "HUFB", u8 version, u8 checksum kind
+ *   the encoded blocks, back to back
+ *   index: u64 offset, u64 uncompressed size and u32 checksum of every block
+ *          (all blocks but the last have the first block's size, at most
+ *          max_container_block_size)
+ *   footer: u64 index offset, u32 block count, u32 checksum of the header and index
+ *
+ * Checksums cover the encoded bytes, so verify() finds corruption without
+ * decoding anything; with Checksum::none they are stored as zero.
+ */
+class BlockCodec {
+    /* Outer handles */
+public:
+    static constexpr char magic[4] = { 'H', 'U', 'F', 'B' };
+    static constexpr std::uint8_t version = 1;
+    static constexpr std::size_t header_size = 6;
+    static constexpr std::size_t index_entry_size = 20;
+    static constexpr std::size_t footer_size = 16;
+    /* the most a container may decode to, so the output size always fits a std::string */
+    static constexpr std::uint64_t max_raw_size = std::numeric_limits<std::ptrdiff_t>::max();
+
+    explicit BlockCodec(BlockOptions options = {})
+        : options(options)
+        , pool(options.threads) {
+        if (this->options.block_size == 0) {
+            this->options.block_size = BlockOptions{}.block_size;
+        }
+        this->options.block_size = std::min(this->options.block_size, max_container_block_size);
+    }
+
+    std::string encode(const char* data, std::size_t size) {
+        std::size_t block_count = (size + options.block_size - 1) / options.block_size;
+        std::vector<std::string> blocks(block_count);
+        std::vector<std::uint32_t> block_checksums(block_count);
+
+        pool.parallel_for(block_count, [&](std::size_t i) {
+            std::size_t begin = i * options.block_size;
+            std::size_t length = std::min(options.block_size, size - begin);
+            blocks[i].reserve(length / 2 + 64);
+            encode_block(data + begin, length, blocks[i], options.code_length_limit, options.streams);
+            block_checksums[i] = block_checksum(options.checksum, blocks[i].data(), blocks[i].size());
+        });
+
+        std::string encoded = container_header(options.checksum);
+        std::size_t total = header_size + index_entry_size * block_count + footer_size;
+        for (const std::string& block : blocks) {
+            total += block.size();
+        }
+        encoded.reserve(total);
+
+        std::vector<BlockIndexEntry> index(block_count);
+        for (std::size_t i = 0; i < block_count; ++i) {
+            index[i].offset = encoded.size();
+            index[i].raw_size = std::min(options.block_size, size - i * options.block_size);
+            index[i].checksum = block_checksums[i];
+            encoded += blocks[i];
+        }
+        encoded += container_trailer(index, encoded.size(), options.checksum);
+        return encoded;
+    }
+
+    std::string encode(std::string_view text) {
+        return encode(text.data(), text.size());
+    }
+
+    /* decodes all blocks concurrently; returns "" for a malformed container */
+    std::string decode(std::string_view encoded) {
+        std::vector<BlockIndexEntry> index;
+        if (!read_index(encoded, index)) {
+            return {};
+        }
+
+        std::string decoded(index.empty() ? 0 : index.back().raw_offset + index.back().raw_size, '\0');
+        if (!decode_blocks(encoded, index, 0, index.size(), decoded.data())) {
+            return {};
+        }
+        return decoded;
+    }
+
+    /* decodes only the blocks overlapping [offset, offset + length), clamped to the input size */
+    std::string decode_range(std::string_view encoded, std::uint64_t offset, std::uint64_t length) {
+        std::vector<BlockIndexEntry> index;
+        if (!read_index(encoded, index) || index.empty() || length == 0) {
+            return {};
+        }
+
+        std::uint64_t raw_end = index.back().raw_offset + index.back().raw_size;
+        if (offset >= raw_end) {
+            return {};
+        }
+        std::uint64_t end = offset + std::min(length, raw_end - offset);
+
+        auto covers = [](const BlockIndexEntry& entry, std::uint64_t position) {
+            return entry.raw_offset + entry.raw_size <= position;
+        };
+        std::size_t first = std::partition_point(index.begin(), index.end(), [&](const BlockIndexEntry& e) {
+                                return covers(e, offset);
+                            }) - index.begin();
+        std::size_t last = std::partition_point(index.begin(), index.end(), [&](const BlockIndexEntry& e) {
+                               return covers(e, end - 1);
+                           }) - index.begin();
+
+        std::uint64_t span_offset = index[first].raw_offset;
+        std::string span(index[last].raw_offset + index[last].raw_size - span_offset, '\0');
+        if (!decode_blocks(encoded, index, first, last + 1, span.data())) {
+            return {};
+        }
+        return span.substr(offset - span_offset, end - offset);
+    }
+
+    /* what a container starts with */
+    static std::string container_header(Checksum checksum) {
+        std::string header(magic, sizeof(magic));
+        header.push_back(static_cast<char>(version));
+        header.push_back(static_cast<char>(checksum));
+        return header;
+    }
+
+    /*
+     * The index and footer that end a container whose blocks end at
+     * `index_offset`; each entry needs its offset, raw size and checksum.
+     * Containers can be written block by block with these two.
+     */
+    static std::string container_trailer(const std::vector<BlockIndexEntry>& index,
+                                         std::uint64_t index_offset,
+                                         Checksum checksum) {
+        std::string trailer;
+        trailer.reserve(index_entry_size * index.size() + footer_size);
+        for (const BlockIndexEntry& entry : index) {
+            append_le64(trailer, entry.offset);
+            append_le64(trailer, entry.raw_size);
+            append_le32(trailer, entry.checksum);
+        }
+        append_le64(trailer, index_offset);
+        append_le32(trailer, static_cast<std::uint32_t>(index.size()));
+
+        std::string header = container_header(checksum);
+        append_le32(trailer, trailer_checksum(header.data(), trailer.data(), trailer.size(), checksum));
+        return trailer;
+    }
+
+    /*
+     * Checks the index and every block checksum without decoding anything;
+     * a container without checksums only gets the structural checks.
+     */
+    bool verify(std::string_view encoded) {
+        std::vector<BlockIndexEntry> index;
+        if (!read_index(encoded, index)) {
+            return false;
+        }
+
+        std::atomic<bool> ok{ true };
+        pool.parallel_for(index.size(), [&](std::size_t i) {
+            if (!block_intact(encoded, index[i])) {
+                ok = false;
+            }
+        });
+        return ok;
+    }
+
+    /* false if `encoded` is not a container of a known version and checksum kind */
+    static bool read_header(std::string_view encoded, Checksum& checksum) {
+        if (encoded.size() < header_size + footer_size ||
+            encoded.compare(0, sizeof(magic), std::string_view(magic, sizeof(magic))) != 0 ||
+            static_cast<std::uint8_t>(encoded[4]) != version) {
+            return false;
+        }
+
+        auto kind = static_cast<Checksum>(encoded[5]);
+        if (kind != Checksum::none && kind != Checksum::crc32c) {
+            return false;
+        }
+        checksum = kind;
+        return true;
+    }
+
+    /* false if the header, the footer or the index does not describe `encoded` */
+    static bool read_index(std::string_view encoded, std::vector<BlockIndexEntry>& index) {
+        Checksum checksum;
+        if (!read_header(encoded, checksum)) {
+            return false;
+        }
+
+        const char* footer = encoded.data() + encoded.size() - footer_size;
+        std::uint64_t index_offset = load_le64(footer);
+        std::uint32_t block_count = load_le32(footer + 8);
+        if (std::uint64_t{ index_entry_size } * block_count > encoded.size() - header_size - footer_size ||
+            index_offset != encoded.size() - footer_size - std::uint64_t{ index_entry_size } * block_count ||
+            load_le32(footer + 12) != index_checksum(encoded, index_offset, block_count, checksum)) {
+            return false;
+        }
+
+        /* the first block's size is the container's block size; it bounds every allocation decode() makes */
+        std::uint64_t block_size = block_count ? load_le64(encoded.data() + index_offset + 8) : 0;
+        if (block_size > max_container_block_size) {
+            return false;
+        }
+
+        index.resize(block_count);
+        std::uint64_t raw_offset = 0;
+        for (std::uint32_t i = 0; i < block_count; ++i) {
+            const char* entry = encoded.data() + index_offset + index_entry_size * i;
+            index[i].offset = load_le64(entry);
+            index[i].raw_offset = raw_offset;
+            index[i].raw_size = load_le64(entry + 8);
+            index[i].checksum = load_le32(entry + 16);
+
+            bool last = i + 1 == block_count;
+            if (index[i].raw_size == 0 || index[i].raw_size > block_size || (!last && index[i].raw_size != block_size) ||
+                raw_offset > max_raw_size - index[i].raw_size) {
+                return false;
+            }
+            raw_offset += index[i].raw_size;
+        }
+        for (std::uint32_t i = 0; i < block_count; ++i) {
+            std::uint64_t next = i + 1 < block_count ? index[i + 1].offset : index_offset;
+            if (next < index[i].offset || index[i].offset < header_size) {
+                return false;
+            }
+            index[i].size = next - index[i].offset;
+
+            if (index[i].raw_size > max_decoded_block_size(encoded.data() + index[i].offset, index[i].size)) {
+                return false;
+            }
+        }
+        return block_count == 0 || index[0].offset == header_size;
+    }
+
+    const BlockOptions& get_options() const {
+        return options;
+    }
+
+    /* Inner machinery */
+private:
+    BlockOptions options;
+    ThreadPool pool;
+
+    /* decodes blocks [first, last) into `out`, which starts at the raw offset of block `first` */
+    bool decode_blocks(std::string_view encoded,
+                       const std::vector<BlockIndexEntry>& index,
+                       std::size_t first,
+                       std::size_t last,
+                       char* out) {
+        std::atomic<bool> ok{ true };
+        std::uint64_t base = first < last ? index[first].raw_offset : 0;
+
+        pool.parallel_for(last - first, [&](std::size_t i) {
+            const BlockIndexEntry& entry = index[first + i];
+            if (!block_intact(encoded, entry) ||
+                !decode_block(encoded.data() + entry.offset,
+                              entry.size,
+                              out + (entry.raw_offset - base),
+                              entry.raw_size)) {
+                ok = false;
+            }
+        });
+        return ok;
+    }
+
+    /* the checksum kind is taken from the header, which read_index() has validated */
+    static bool block_intact(std::string_view encoded, const BlockIndexEntry& entry) {
+        auto checksum = static_cast<Checksum>(encoded[5]);
+        return block_checksum(checksum, encoded.data() + entry.offset, entry.size) == entry.checksum;
+    }
+
+    /* covers the header and the index, so a damaged offset or size is caught before any block is read */
+    static std::uint32_t index_checksum(std::string_view encoded,
+                                        std::uint64_t index_offset,
+                                        std::uint32_t block_count,
+                                        Checksum checksum) {
+        /* the entries plus the footer fields in front of the checksum itself */
+        std::size_t covered = index_entry_size * block_count + footer_size - 4;
+        return trailer_checksum(encoded.data(), encoded.data() + index_offset, covered, checksum);
+    }
+
+    static std::uint32_t trailer_checksum(const char* header, const char* trailer, std::size_t size, Checksum checksum) {
+        if (checksum != Checksum::crc32c) {
+            return 0;
+        }
+        return crc32c(trailer, size, crc32c(header, header_size));
+    }
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* fixed-width little-endian integers for container headers and indices */
+inline void append_le32(std::string& out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+inline void append_le64(std::string& out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+inline void store_le32(char* data, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        data[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+inline std::uint32_t load_le32(const char* data) {
+    std::uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+inline std::uint64_t load_le64(const char* data) {
+    std::uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+/* longest varint: ten bytes for a 64-bit value */
+inline constexpr std::size_t max_varint_size = 10;
+
+/* LEB128: seven bits per byte, low groups first, the high bit set on all but the last byte */
+template <typename Out>
+void append_varint(Out& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/* reads a varint at `pos` and advances it; false if truncated or longer than 64 bits */
+inline bool read_varint(const char* data, std::size_t size, std::size_t& pos, std::uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && pos < size; shift += 7) {
+        auto byte = static_cast<unsigned char>(data[pos++]);
+        value |= std::uint64_t{ byte & 0x7Fu } << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
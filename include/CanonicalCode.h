@@ -0,0 +1,144 @@
+#ifndef CANONICAL_CODE_H
+#define CANONICAL_CODE_H
+
+#include "./DecodeTable.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Code length per byte value, 0 means the symbol does not occur. The functions
+ * below take any indexable container of lengths (e.g. std::vector<uint8_t>
+ * for wider alphabets, see BasicHuffman.h); the index is the symbol.
+ */
+using CodeLengths = std::array<std::uint8_t, 256>;
+
+inline constexpr unsigned max_code_length = 56;
+
+/*
+ * Codes are handed out in (length, symbol) order, each one being the previous
+ * code plus one, shifted left whenever the length grows. The code lengths
+ * alone are therefore enough to rebuild the whole code. The result is sorted
+ * the same (length, symbol) way.
+ */
+template <typename Lengths>
+std::vector<PrefixCode> assign_canonical_codes(const Lengths& lengths) {
+    std::array<std::uint32_t, max_code_length + 1> length_count{};
+    for (std::uint8_t length : lengths) {
+        if (length && length <= max_code_length) {
+            length_count[length]++;
+        }
+    }
+
+    std::array<std::uint64_t, max_code_length + 1> next_code{};
+    std::array<std::size_t, max_code_length + 1> slot{};
+    std::uint64_t code = 0;
+    std::size_t used = 0;
+    for (unsigned length = 1; length <= max_code_length; ++length) {
+        code = (code + length_count[length - 1]) << 1;
+        next_code[length] = code;
+        slot[length] = used;
+        used += length_count[length];
+    }
+
+    std::vector<PrefixCode> codes(used);
+    for (std::uint32_t symbol = 0; symbol < lengths.size(); ++symbol) {
+        unsigned length = lengths[symbol];
+        if (length && length <= max_code_length) {
+            codes[slot[length]++] = PrefixCode{ symbol, next_code[length]++, length };
+        }
+    }
+    return codes;
+}
+
+/* Kraft check: lengths must fit `max_code_length` and must not oversubscribe the code space */
+template <typename Lengths>
+bool is_valid_code_lengths(const Lengths& lengths) {
+    std::uint64_t used = 0;
+    for (std::uint8_t length : lengths) {
+        if (length > max_code_length) {
+            return false;
+        }
+        if (length) {
+            used += std::uint64_t{ 1 } << (max_code_length - length);
+            if (used > (std::uint64_t{ 1 } << max_code_length)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * Header layout, one byte per item until 256 lengths are described:
+ *   0x00..0x3F  a single code length
+ *   0x40 | n    previous length repeated n + 1 more times
+ *   0x80 | n    n + 1 absent symbols
+ */
+template <typename Lengths, typename Out>
+void write_code_lengths(const Lengths& lengths, Out& out) {
+    std::size_t i = 0;
+    while (i < lengths.size()) {
+        std::uint8_t length = lengths[i];
+        std::size_t run = 1;
+        while (i + run < lengths.size() && lengths[i + run] == length) {
+            ++run;
+        }
+        i += run;
+
+        if (length == 0) {
+            for (; run > 0; run -= std::min<std::size_t>(run, 128)) {
+                out.push_back(static_cast<char>(0x80 | (std::min<std::size_t>(run, 128) - 1)));
+            }
+            continue;
+        }
+
+        out.push_back(static_cast<char>(length));
+        for (--run; run > 0; run -= std::min<std::size_t>(run, 64)) {
+            out.push_back(static_cast<char>(0x40 | (std::min<std::size_t>(run, 64) - 1)));
+        }
+    }
+}
+
+/* fills all of `lengths`; returns the number of header bytes consumed, 0 if the header is truncated or malformed */
+template <typename Lengths>
+std::size_t read_code_lengths(const char* data, std::size_t size, Lengths& lengths) {
+    std::size_t filled = 0;
+    std::size_t pos = 0;
+
+    while (filled < lengths.size()) {
+        if (pos == size) {
+            return 0;
+        }
+        auto item = static_cast<std::uint8_t>(data[pos++]);
+
+        std::size_t run = (item & 0x3F) + 1;
+        std::uint8_t length = 0;
+        if (item & 0x80) {
+            length = 0;
+            run = (item & 0x7F) + 1;
+        } else if (item & 0x40) {
+            if (filled == 0 || lengths[filled - 1] == 0) {
+                return 0;
+            }
+            length = lengths[filled - 1];
+        } else {
+            length = item;
+            run = 1;
+        }
+
+        if (filled + run > lengths.size()) {
+            return 0;
+        }
+        for (; run > 0; --run) {
+            lengths[filled++] = length;
+        }
+    }
+
+    return is_valid_code_lengths(lengths) ? pos : 0;
+}
+
+#endif
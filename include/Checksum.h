@@ -0,0 +1,85 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include "./CpuFeatures.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/* integrity check stored with every block of a container or stream */
+enum class Checksum : std::uint8_t { none = 0, crc32c = 1 };
+
+namespace checksum_detail {
+
+/* reflected Castagnoli polynomial */
+inline constexpr std::uint32_t crc32c_polynomial = 0x82F63B78;
+
+inline constexpr std::array<std::uint32_t, 256> crc32c_table = [] {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t byte = 0; byte < 256; ++byte) {
+        std::uint32_t crc = byte;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ crc32c_polynomial : crc >> 1;
+        }
+        table[byte] = crc;
+    }
+    return table;
+}();
+
+}   // namespace checksum_detail
+
+/*
+ * CRC-32C of `data`. Passing the result of a previous call as `crc` continues
+ * it, so crc32c(b, crc32c(a)) is the checksum of a followed by b.
+ */
+inline std::uint32_t crc32c_scalar(const char* data, std::size_t size, std::uint32_t crc = 0) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = checksum_detail::crc32c_table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#ifdef HUFFMAN_X86
+
+/* the SSE4.2 crc32 instruction, eight bytes at a time */
+__attribute__((target("sse4.2"))) inline std::uint32_t crc32c_sse42(const char* data,
+                                                                    std::size_t size,
+                                                                    std::uint32_t crc = 0) {
+    std::uint64_t state = ~crc;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        state = _mm_crc32_u64(state, word);
+    }
+    auto tail = static_cast<std::uint32_t>(state);
+    for (; i < size; ++i) {
+        tail = _mm_crc32_u8(tail, static_cast<unsigned char>(data[i]));
+    }
+    return ~tail;
+}
+
+#endif
+
+/* runs the hardware instruction when this CPU has it */
+inline std::uint32_t crc32c(const char* data,
+                            std::size_t size,
+                            std::uint32_t crc = 0,
+                            SimdLevel level = detected_simd_level()) {
+#ifdef HUFFMAN_X86
+    if (usable_simd_level(level) >= SimdLevel::sse42) {
+        return crc32c_sse42(data, size, crc);
+    }
+#endif
+    return crc32c_scalar(data, size, crc);
+}
+
+/* the stored value for `kind`: 0 when there is no checksum */
+inline std::uint32_t block_checksum(Checksum kind, const char* data, std::size_t size) {
+    return kind == Checksum::crc32c ? crc32c(data, size) : 0;
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef CODE_TABLE_H
+#define CODE_TABLE_H
+
+#include "./Block.h"
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+/*
+ * A trained prefix code that stands on its own: it keeps the code lengths and
+ * the encode/decode tables built from them, never the training data. Train it
+ * once on a sample (or on merged histograms), ship serialize()'s bytes, load
+ * them with deserialize() and encode any number of messages.
+ *
+ * A message encoded with a table is a bare bitstream plus its trailer byte
+ * (see Block.h); it carries no header, so it must be decoded with the same
+ * table.
+ */
+class CodeTable {
+    /* Outer handles */
+public:
+    /* the empty table: it encodes only empty messages */
+    CodeTable() = default;
+
+    /* `lengths` must pass is_valid_code_lengths */
+    explicit CodeTable(const CodeLengths& lengths)
+        : code_lengths(lengths)
+        , encode_table(make_flat_encode_table(lengths))
+        , decode_table(assign_canonical_codes(lengths)) {
+    }
+
+    /*
+     * `cover_all_bytes` gives byte values missing from the sample a code too,
+     * at the cost of slightly longer codes for the others, so that the table
+     * can encode messages the sample did not anticipate.
+     */
+    static CodeTable train(FrequencyTable frequency_table,
+                           unsigned code_length_limit = max_code_length,
+                           bool cover_all_bytes = false) {
+        if (cover_all_bytes) {
+            for (std::uint64_t& frequency : frequency_table) {
+                frequency = frequency ? frequency * 2 : 1;
+            }
+        }
+        return CodeTable(train_code_lengths(frequency_table, code_length_limit));
+    }
+
+    static CodeTable train(const char* sample,
+                           std::size_t size,
+                           unsigned code_length_limit = max_code_length,
+                           bool cover_all_bytes = false) {
+        return train(count_frequencies(sample, size), code_length_limit, cover_all_bytes);
+    }
+
+    /* the code length header of Block.h, so a table costs at most 256 bytes */
+    std::string serialize() const {
+        std::string out;
+        write_code_lengths(code_lengths, out);
+        return out;
+    }
+
+    /* returns how many bytes of `data` the table took, 0 if they do not start with a valid table */
+    static std::size_t deserialize(const char* data, std::size_t size, CodeTable& table) {
+        CodeLengths lengths{};
+        std::size_t consumed = read_code_lengths(data, size, lengths);
+        if (consumed) {
+            table = CodeTable(lengths);
+        }
+        return consumed;
+    }
+
+    bool empty() const {
+        return decode_table.empty();
+    }
+
+    const CodeLengths& get_code_lengths() const {
+        return code_lengths;
+    }
+    const FlatEncodeTable& get_encode_table() const {
+        return encode_table;
+    }
+
+    /* true if every byte of `data` has a code */
+    bool can_encode(const char* data, std::size_t size) const {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+        unsigned missing = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            missing |= FlatEncodeTable::length(encode_table[bytes[i]]) == 0;
+        }
+        return missing == 0;
+    }
+
+    /* bytes encode() appends for `size` bytes of any input it accepts */
+    std::size_t max_encoded_size(std::size_t size) const {
+        unsigned longest = *std::max_element(code_lengths.begin(), code_lengths.end());
+        return (size * longest + 7) / 8 + 1;
+    }
+
+    /* appends the message to `out` (std::string or SpanBuffer); false, appending nothing, if a byte of `data` has no code */
+    template <typename Out>
+    bool encode(const char* data, std::size_t size, Out& out) const {
+        if (!can_encode(data, size)) {
+            return false;
+        }
+        write_bitstream(encode_table, data, size, out);
+        return true;
+    }
+
+    /* appends the decoded message to `out`; false if the message is malformed */
+    bool decode(const char* data, std::size_t size, std::string& out) const {
+        BitstreamView stream;
+        if (!parse_bitstream(data, size, stream)) {
+            return false;
+        }
+
+        BitReader reader(stream.packed, stream.packed_size, stream.bit_count);
+        decode_table.decode(reader, out);
+        return reader.consumed() == stream.bit_count;
+    }
+
+    /* decodes into `out`; false if the message is malformed or does not fit in `capacity` bytes */
+    bool decode(const char* data, std::size_t size, char* out, std::size_t capacity, std::size_t& written) const {
+        BitstreamView stream;
+        written = 0;
+        if (!parse_bitstream(data, size, stream)) {
+            return false;
+        }
+
+        BitReader reader(stream.packed, stream.packed_size, stream.bit_count);
+        written = decode_table.decode(reader, out, capacity);
+        return reader.consumed() == stream.bit_count;
+    }
+
+    bool operator==(const CodeTable& other) const {
+        return code_lengths == other.code_lengths;
+    }
+
+    /* Inner machinery */
+private:
+    CodeLengths code_lengths{};
+    FlatEncodeTable encode_table{};
+    DecodeTable decode_table;
+};
+
+#endif
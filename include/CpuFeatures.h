@@ -0,0 +1,37 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#if defined(__x86_64__)
+#define HUFFMAN_X86 1
+#include <immintrin.h>
+#endif
+
+/* instruction sets the hand-written kernels are built for, in increasing order */
+enum class SimdLevel { scalar, sse42, avx2 };
+
+/* the best level this CPU supports, from CPUID on first use */
+inline SimdLevel detected_simd_level() {
+#ifdef HUFFMAN_X86
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::avx2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return SimdLevel::sse42;
+        }
+        return SimdLevel::scalar;
+    }();
+    return level;
+#else
+    return SimdLevel::scalar;
+#endif
+}
+
+/* `requested` lowered to what the CPU can run, so callers may ask for any level */
+inline SimdLevel usable_simd_level(SimdLevel requested) {
+    SimdLevel detected = detected_simd_level();
+    return requested < detected ? requested : detected;
+}
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef DECODE_TABLE_H
+#define DECODE_TABLE_H
+
+#include "./BitStream.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct PrefixCode {
+    std::uint32_t symbol;
+    std::uint64_t code;
+    unsigned length;
+};
+
+/* leaf: `value` is the symbol and `bits` the remaining code length; link: `value` is the subtable offset and `bits` its index width */
+struct DecodeEntry {
+    std::uint32_t value = 0;
+    std::uint8_t bits = 0;
+    bool is_link = false;
+};
+
+/*
+ * Multi-level lookup table: the root is indexed by the next `root_bits` bits
+ * of the stream and resolves every code of at most that length in one access.
+ * Longer codes go through a link entry into a subtable indexed by the bits
+ * that follow.
+ */
+class DecodeTable {
+public:
+    static constexpr unsigned root_bits = 11;
+    static constexpr unsigned max_sub_bits = 11;
+
+    DecodeTable() = default;
+
+    /* codes must form a prefix code, each at most 56 bits long */
+    explicit DecodeTable(const std::vector<PrefixCode>& codes) {
+        if (codes.empty()) {
+            return;
+        }
+        entries.resize(std::size_t{ 1 } << root_bits);
+        build_level(codes, 0, root_bits, 0);
+    }
+
+    bool empty() const {
+        return entries.empty();
+    }
+
+    std::size_t size() const {
+        return entries.size();
+    }
+
+    /* decodes until the reader is exhausted or an invalid code is met */
+    void decode(BitReader& reader, std::string& out) const {
+        if (entries.empty()) {
+            return;
+        }
+
+        while (!reader.exhausted()) {
+            int symbol = decode_symbol(reader);
+            if (symbol < 0) {
+                return;
+            }
+            out.push_back(static_cast<char>(symbol));
+        }
+    }
+
+    /* decodes at most `capacity` symbols into `out`, returns how many were written */
+    std::size_t decode(BitReader& reader, char* out, std::size_t capacity) const {
+        if (entries.empty()) {
+            return 0;
+        }
+
+        std::size_t written = 0;
+        while (written < capacity && !reader.exhausted()) {
+            int symbol = decode_symbol(reader);
+            if (symbol < 0) {
+                break;
+            }
+            out[written++] = static_cast<char>(symbol);
+        }
+        return written;
+    }
+
+    /* -1 if the upcoming bits are not a code */
+    int decode_symbol(BitReader& reader) const {
+        const DecodeEntry* entry = &entries[reader.peek(root_bits)];
+        unsigned width = root_bits;
+
+        while (entry->is_link) {
+            reader.consume(width);
+            width = entry->bits;
+            entry = &entries[entry->value + reader.peek(width)];
+        }
+
+        if (entry->bits == 0) {
+            return -1;
+        }
+        reader.consume(entry->bits);
+        return static_cast<int>(entry->value);
+    }
+
+private:
+    std::vector<DecodeEntry> entries;
+
+    static std::uint64_t code_chunk(const PrefixCode& code, unsigned consumed, unsigned take) {
+        unsigned shift = code.length - consumed - take;
+        return (code.code >> shift) & ((std::uint64_t{ 1 } << take) - 1);
+    }
+
+    void build_level(const std::vector<PrefixCode>& codes,
+                     unsigned consumed,
+                     unsigned width,
+                     std::size_t offset) {
+        std::map<std::uint64_t, std::vector<PrefixCode>> long_codes;
+
+        for (const PrefixCode& code : codes) {
+            unsigned rest = code.length - consumed;
+
+            if (rest <= width) {
+                std::uint64_t first = code_chunk(code, consumed, rest) << (width - rest);
+                std::uint64_t span = std::uint64_t{ 1 } << (width - rest);
+                DecodeEntry leaf{ code.symbol, static_cast<std::uint8_t>(rest), false };
+                std::fill_n(entries.begin() + offset + first, span, leaf);
+            } else {
+                long_codes[code_chunk(code, consumed, width)].push_back(code);
+            }
+        }
+
+        for (const auto& [chunk, group] : long_codes) {
+            unsigned longest = 0;
+            for (const PrefixCode& code : group) {
+                longest = std::max(longest, code.length - consumed - width);
+            }
+            unsigned sub_bits = std::min(longest, max_sub_bits);
+
+            std::size_t sub_offset = entries.size();
+            entries.resize(sub_offset + (std::size_t{ 1 } << sub_bits));
+            entries[offset + chunk] = DecodeEntry{ static_cast<std::uint32_t>(sub_offset),
+                                                   static_cast<std::uint8_t>(sub_bits),
+                                                   true };
+            build_level(group, consumed + width, sub_bits, sub_offset);
+        }
+    }
+};
+
+#endif
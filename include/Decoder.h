@@ -1,24 +1,30 @@
 #ifndef DECODER_H
 #define DECODER_H
 
+#include <cstddef>
+#include <span>
 #include <string>
 
 /* Absstract-base class */
 class Decoder {
 
 public:
-    explicit Decoder(std::string text)
-        : text_to_decode(std::move(text)) {
-    }
-
     /* pure virtual functions */
-    virtual std::string encode(std::string& text) = 0;
-    virtual std::string decode(std::string& text) = 0;
+    /* const and safe to call concurrently on one instance */
+    virtual std::string encode(const std::string& text) const = 0;
+    virtual std::string decode(const std::string& text) const = 0;
 
-    virtual ~Decoder() = default;
+    /*
+     * The same formats read from and written into caller-owned memory:
+     * `written` receives the output size, and false means the input is
+     * malformed or the output does not fit. An `out` of max_encoded_size()
+     * bytes always fits encode().
+     */
+    virtual bool encode(std::span<const std::byte> text, std::span<std::byte> out, std::size_t& written) const = 0;
+    virtual bool decode(std::span<const std::byte> text, std::span<std::byte> out, std::size_t& written) const = 0;
+    virtual std::size_t max_encoded_size(std::size_t size) const = 0;
 
-protected:
-    std::string text_to_decode;
+    virtual ~Decoder() = default;
 };
 
 #endif
@@ -0,0 +1,174 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* read-only mapping of a whole file, advised for one sequential pass */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            return;
+        }
+        length = static_cast<std::size_t>(info.st_size);
+        if (length == 0) {
+            mapped = true;
+            return;
+        }
+
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            length = 0;
+            return;
+        }
+        ::madvise(address, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*>(address);
+        mapped = true;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (bytes) {
+            ::munmap(const_cast<char*>(bytes), length);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool ok() const {
+        return mapped;
+    }
+    const char* data() const {
+        return bytes;
+    }
+    std::size_t size() const {
+        return length;
+    }
+    std::string_view view() const {
+        return { bytes, length };
+    }
+
+private:
+    int fd = -1;
+    const char* bytes = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+};
+
+/* for inputs that cannot be mapped (pipes, terminals) */
+inline bool read_all(int fd, std::string& out) {
+    char buffer[1 << 16];
+    while (true) {
+        ssize_t got = ::read(fd, buffer, sizeof(buffer));
+        if (got == 0) {
+            return true;
+        }
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        out.append(buffer, static_cast<std::size_t>(got));
+    }
+}
+
+/*
+ * Buffered writer flushing in large page-aligned chunks; writes at least one
+ * buffer long skip the copy when nothing is pending.
+ */
+class AlignedWriter {
+public:
+    static constexpr std::size_t alignment = 4096;
+
+    explicit AlignedWriter(int fd, std::size_t capacity = std::size_t{ 1 } << 20)
+        : fd(fd)
+        , capacity((capacity + alignment - 1) / alignment * alignment)
+        , buffer(static_cast<char*>(std::aligned_alloc(alignment, this->capacity))) {
+    }
+
+    AlignedWriter(const AlignedWriter&) = delete;
+    AlignedWriter& operator=(const AlignedWriter&) = delete;
+
+    ~AlignedWriter() {
+        flush();
+        std::free(buffer);
+    }
+
+    bool write(const char* data, std::size_t size) {
+        if (pending == 0 && size >= capacity) {
+            return write_fully(data, size);
+        }
+
+        while (size > 0) {
+            std::size_t chunk = std::min(size, capacity - pending);
+            std::memcpy(buffer + pending, data, chunk);
+            pending += chunk;
+            data += chunk;
+            size -= chunk;
+
+            if (pending == capacity && !flush()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool write(std::string_view data) {
+        return write(data.data(), data.size());
+    }
+
+    bool flush() {
+        bool written = write_fully(buffer, pending);
+        pending = 0;
+        return written;
+    }
+
+    bool ok() const {
+        return buffer && !failed;
+    }
+
+private:
+    int fd;
+    std::size_t capacity;
+    char* buffer;
+    std::size_t pending = 0;
+    bool failed = false;
+
+    bool write_fully(const char* data, std::size_t size) {
+        while (size > 0 && !failed) {
+            ssize_t put = ::write(fd, data, size);
+            if (put < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                failed = true;
+                break;
+            }
+            data += put;
+            size -= static_cast<std::size_t>(put);
+        }
+        return !failed;
+    }
+};
+
+#endif
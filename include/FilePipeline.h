@@ -0,0 +1,283 @@
+#ifndef FILE_PIPELINE_H
+#define FILE_PIPELINE_H
+
+#include "./BlockCodec.h"
+#include "./IoQueue.h"
+#include "./ThreadPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+struct PipelineOptions {
+    BlockOptions block;
+    /* blocks being read, compressed or written at once; 0 means two per compression thread */
+    unsigned max_in_flight = 0;
+    IoBackend backend = IoBackend::automatic;
+};
+
+/*
+ * Compresses a regular file into the BlockCodec container with reads,
+ * compression and writes overlapped: every slot holds one block and cycles
+ * through an asynchronous read into its (registered) input buffer, encoding
+ * on the thread pool and an asynchronous write of the result. Blocks are
+ * given their output offsets strictly in order, so the container is byte for
+ * byte the one BlockCodec::encode() produces, while the writes themselves
+ * complete in any order. Memory stays under memory_ceiling() whatever the
+ * file size.
+ */
+class FilePipeline {
+    /* Outer handles */
+public:
+    explicit FilePipeline(PipelineOptions options = {})
+        : options(options)
+        , pool(options.block.threads) {
+        if (this->options.block.block_size == 0) {
+            this->options.block.block_size = BlockOptions{}.block_size;
+        }
+        this->options.block.block_size = std::min(this->options.block.block_size, max_container_block_size);
+        if (this->options.max_in_flight == 0) {
+            this->options.max_in_flight = std::max(2u, 2 * options.block.threads);
+        }
+    }
+
+    /*
+     * Writes the container into `out_fd` starting at byte `out_start`; false if
+     * `in_fd` is not a regular file, `out_fd` does not accept pwrite or was
+     * opened with O_APPEND (positioned writes would land in completion order),
+     * or any I/O fails.
+     */
+    bool compress(int in_fd, int out_fd, std::uint64_t out_start = 0) {
+        struct stat info;
+        if (::fstat(in_fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            return false;
+        }
+        int out_flags = ::fcntl(out_fd, F_GETFL);
+        if (out_flags < 0 || (out_flags & O_APPEND)) {
+            return false;
+        }
+        raw_size = static_cast<std::uint64_t>(info.st_size);
+        encoded_size = 0;
+
+        const std::size_t block_size = options.block.block_size;
+        const std::uint64_t block_count = (raw_size + block_size - 1) / block_size;
+        const std::size_t slot_count = static_cast<std::size_t>(std::min<std::uint64_t>(options.max_in_flight, block_count));
+
+        std::vector<Slot> slots(slot_count);
+        std::vector<iovec> buffers(slot_count);
+        for (std::size_t s = 0; s < slot_count; ++s) {
+            slots[s].input.reset(static_cast<char*>(std::aligned_alloc(buffer_alignment, input_capacity())));
+            slots[s].output.reserve(max_encoded_block_size(block_size));
+            if (!slots[s].input) {
+                return false;
+            }
+            buffers[s] = iovec{ slots[s].input.get(), input_capacity() };
+        }
+
+        std::unique_ptr<IoQueue> io = make_io_queue(options.backend, static_cast<unsigned>(2 * slot_count + 2), buffers);
+        backend = io->name();
+
+        std::string header = BlockCodec::container_header(options.block.checksum);
+        if (!pwrite_all(out_fd, header.data(), header.size(), out_start)) {
+            return false;
+        }
+
+        std::vector<BlockIndexEntry> index(block_count);
+        std::uint64_t next_write = 0;
+        std::uint64_t out_offset = header.size();
+        std::size_t outstanding = 0;
+        bool failed = false;
+
+        auto read_rest = [&](std::size_t s) {
+            Slot& slot = slots[s];
+            io->read(in_fd,
+                     slot.input.get() + slot.done,
+                     slot.raw_size - slot.done,
+                     slot.block * block_size + slot.done,
+                     static_cast<int>(s),
+                     tag(s, Op::read));
+            ++outstanding;
+        };
+        auto write_rest = [&](std::size_t s) {
+            Slot& slot = slots[s];
+            io->write(out_fd,
+                      slot.output.data() + slot.done,
+                      slot.output.size() - slot.done,
+                      out_start + slot.out_offset + slot.done,
+                      tag(s, Op::write));
+            ++outstanding;
+        };
+        auto start_block = [&](std::size_t s, std::uint64_t block) {
+            Slot& slot = slots[s];
+            slot.block = block;
+            slot.raw_size = static_cast<std::size_t>(std::min<std::uint64_t>(block_size, raw_size - block * block_size));
+            slot.done = 0;
+            slot.compressed = false;
+            read_rest(s);
+        };
+        /* block b always lives in slot b % slot_count, so the next block to write is easy to find */
+        auto issue_writes = [&]() {
+            while (next_write < block_count) {
+                std::size_t s = static_cast<std::size_t>(next_write % slot_count);
+                Slot& slot = slots[s];
+                if (slot.block != next_write || !slot.compressed) {
+                    break;
+                }
+                slot.out_offset = out_offset;
+                slot.done = 0;
+                index[next_write] = BlockIndexEntry{ out_offset, slot.output.size(), 0, slot.raw_size, slot.checksum };
+                out_offset += slot.output.size();
+                ++next_write;
+                write_rest(s);
+            }
+        };
+
+        for (std::size_t s = 0; s < slot_count; ++s) {
+            start_block(s, s);
+        }
+
+        while (outstanding > 0) {
+            IoCompletion completion = io->wait();
+            --outstanding;
+            auto s = static_cast<std::size_t>(completion.tag >> 2);
+            auto op = static_cast<Op>(completion.tag & 3);
+            Slot& slot = slots[s];
+            if (failed) {
+                continue;
+            }
+
+            if (op == Op::compressed) {
+                slot.compressed = true;
+                issue_writes();
+                continue;
+            }
+
+            if (completion.result == -EINTR || completion.result == -EAGAIN) {
+                op == Op::read ? read_rest(s) : write_rest(s);
+                continue;
+            }
+            /* an error, or a file that shrank under us */
+            if (completion.result <= 0) {
+                failed = true;
+                continue;
+            }
+            slot.done += static_cast<std::size_t>(completion.result);
+
+            if (op == Op::read) {
+                if (slot.done < slot.raw_size) {
+                    read_rest(s);
+                    continue;
+                }
+                ++outstanding;
+                pool.submit([this, &slot, &io, s] {
+                    slot.output.clear();
+                    encode_block(slot.input.get(),
+                                 slot.raw_size,
+                                 slot.output,
+                                 options.block.code_length_limit,
+                                 options.block.streams);
+                    slot.checksum = block_checksum(options.block.checksum, slot.output.data(), slot.output.size());
+                    io->post(tag(s, Op::compressed), 0);
+                });
+            } else if (slot.done < slot.output.size()) {
+                write_rest(s);
+            } else if (slot.block + slot_count < block_count) {
+                start_block(s, slot.block + slot_count);
+            }
+        }
+        if (failed) {
+            return false;
+        }
+
+        std::string trailer = BlockCodec::container_trailer(index, out_offset, options.block.checksum);
+        if (!pwrite_all(out_fd, trailer.data(), trailer.size(), out_start + out_offset)) {
+            return false;
+        }
+        encoded_size = out_offset + trailer.size();
+        return true;
+    }
+
+    /* input plus worst-case output buffers of every slot */
+    std::size_t memory_ceiling() const {
+        return options.max_in_flight * (input_capacity() + max_encoded_block_size(options.block.block_size));
+    }
+
+    /* of the last compress() */
+    std::uint64_t get_raw_size() const {
+        return raw_size;
+    }
+    std::uint64_t get_encoded_size() const {
+        return encoded_size;
+    }
+    const char* get_backend() const {
+        return backend;
+    }
+
+    const PipelineOptions& get_options() const {
+        return options;
+    }
+
+    /* Inner machinery */
+private:
+    static constexpr std::size_t buffer_alignment = 4096;
+
+    enum class Op : std::uint64_t { read = 0, compressed = 1, write = 2 };
+
+    struct FreeDeleter {
+        void operator()(char* p) const {
+            std::free(p);
+        }
+    };
+
+    struct Slot {
+        std::unique_ptr<char, FreeDeleter> input;
+        std::string output;
+        std::uint64_t block = 0;
+        std::size_t raw_size = 0;
+        /* bytes read so far, then bytes written so far */
+        std::size_t done = 0;
+        std::uint64_t out_offset = 0;
+        std::uint32_t checksum = 0;
+        bool compressed = false;
+    };
+
+    PipelineOptions options;
+    ThreadPool pool;
+    std::uint64_t raw_size = 0;
+    std::uint64_t encoded_size = 0;
+    const char* backend = "";
+
+    static std::uint64_t tag(std::size_t slot, Op op) {
+        return std::uint64_t{ slot } << 2 | static_cast<std::uint64_t>(op);
+    }
+
+    std::size_t input_capacity() const {
+        return (options.block.block_size + buffer_alignment - 1) / buffer_alignment * buffer_alignment;
+    }
+
+    static bool pwrite_all(int fd, const char* data, std::size_t size, std::uint64_t offset) {
+        while (size > 0) {
+            ssize_t put = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (put < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += put;
+            size -= static_cast<std::size_t>(put);
+            offset += static_cast<std::uint64_t>(put);
+        }
+        return true;
+    }
+};
+
+#endif
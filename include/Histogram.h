@@ -0,0 +1,173 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "./CpuFeatures.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/* occurrences of every byte value */
+using FrequencyTable = std::array<std::uint64_t, 256>;
+
+/*
+ * Scalar reference. Counts bytes into four interleaved sub-histograms which
+ * are summed at the end: runs of the same byte then increment different
+ * counters, so the increments do not wait on each other's store-to-load
+ * forwarding.
+ */
+inline FrequencyTable count_frequencies_scalar(const char* data, std::size_t size) {
+    std::array<FrequencyTable, 4> sub{};
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+
+        sub[0][word & 0xFF]++;
+        sub[1][(word >> 8) & 0xFF]++;
+        sub[2][(word >> 16) & 0xFF]++;
+        sub[3][(word >> 24) & 0xFF]++;
+        sub[0][(word >> 32) & 0xFF]++;
+        sub[1][(word >> 40) & 0xFF]++;
+        sub[2][(word >> 48) & 0xFF]++;
+        sub[3][word >> 56]++;
+    }
+    for (; i < size; ++i) {
+        sub[0][bytes[i]]++;
+    }
+
+    FrequencyTable frequency_table{};
+    for (std::size_t symbol = 0; symbol < frequency_table.size(); ++symbol) {
+        frequency_table[symbol] = sub[0][symbol] + sub[1][symbol] + sub[2][symbol] + sub[3][symbol];
+    }
+    return frequency_table;
+}
+
+#ifdef HUFFMAN_X86
+
+namespace histogram_detail {
+
+/*
+ * The vector kernels count into eight sub-histograms of 32-bit counters (8 KB,
+ * half the scalar footprint) and fold them into the 64-bit table at least
+ * every `fold_interval` bytes, before any counter can overflow.
+ */
+using SubHistograms = std::array<std::array<std::uint32_t, 256>, 8>;
+inline constexpr std::size_t fold_interval = std::size_t{ 1 } << 31;
+
+inline void count_word(SubHistograms& sub, std::uint64_t word) {
+    sub[0][word & 0xFF]++;
+    sub[1][(word >> 8) & 0xFF]++;
+    sub[2][(word >> 16) & 0xFF]++;
+    sub[3][(word >> 24) & 0xFF]++;
+    sub[4][(word >> 32) & 0xFF]++;
+    sub[5][(word >> 40) & 0xFF]++;
+    sub[6][(word >> 48) & 0xFF]++;
+    sub[7][word >> 56]++;
+}
+
+inline void fold(SubHistograms& sub, FrequencyTable& frequency_table) {
+    for (auto& counts : sub) {
+        for (std::size_t symbol = 0; symbol < counts.size(); ++symbol) {
+            frequency_table[symbol] += counts[symbol];
+        }
+        counts.fill(0);
+    }
+}
+
+}   // namespace histogram_detail
+
+/* 16 bytes per load; a load holding a single repeated byte is counted with one add */
+__attribute__((target("sse4.2"))) inline FrequencyTable count_frequencies_sse42(const char* data, std::size_t size) {
+    using namespace histogram_detail;
+    FrequencyTable frequency_table{};
+    SubHistograms sub{};
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    std::size_t i = 0;
+    while (size - i >= 16) {
+        std::size_t end = i + std::min(size - i, fold_interval);
+        for (; i + 16 <= end; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+            __m128i first = _mm_set1_epi8(static_cast<char>(bytes[i]));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, first)) == 0xFFFF) {
+                sub[0][bytes[i]] += 16;
+                continue;
+            }
+            count_word(sub, static_cast<std::uint64_t>(_mm_extract_epi64(v, 0)));
+            count_word(sub, static_cast<std::uint64_t>(_mm_extract_epi64(v, 1)));
+        }
+        fold(sub, frequency_table);
+    }
+    for (; i < size; ++i) {
+        frequency_table[bytes[i]]++;
+    }
+    return frequency_table;
+}
+
+/* 32 bytes per load; a load holding a single repeated byte is counted with one add */
+__attribute__((target("avx2"))) inline FrequencyTable count_frequencies_avx2(const char* data, std::size_t size) {
+    using namespace histogram_detail;
+    FrequencyTable frequency_table{};
+    SubHistograms sub{};
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    std::size_t i = 0;
+    while (size - i >= 32) {
+        std::size_t end = i + std::min(size - i, fold_interval);
+        for (; i + 32 <= end; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+            __m256i first = _mm256_set1_epi8(static_cast<char>(bytes[i]));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, first)) == -1) {
+                sub[0][bytes[i]] += 32;
+                continue;
+            }
+            count_word(sub, static_cast<std::uint64_t>(_mm256_extract_epi64(v, 0)));
+            count_word(sub, static_cast<std::uint64_t>(_mm256_extract_epi64(v, 1)));
+            count_word(sub, static_cast<std::uint64_t>(_mm256_extract_epi64(v, 2)));
+            count_word(sub, static_cast<std::uint64_t>(_mm256_extract_epi64(v, 3)));
+        }
+        fold(sub, frequency_table);
+    }
+    for (; i < size; ++i) {
+        frequency_table[bytes[i]]++;
+    }
+    return frequency_table;
+}
+
+#endif
+
+/* runs the best kernel up to `level` that this CPU supports */
+inline FrequencyTable count_frequencies(const char* data, std::size_t size, SimdLevel level = detected_simd_level()) {
+    switch (usable_simd_level(level)) {
+#ifdef HUFFMAN_X86
+    case SimdLevel::avx2:
+        return count_frequencies_avx2(data, size);
+    case SimdLevel::sse42:
+        return count_frequencies_sse42(data, size);
+#endif
+    default:
+        return count_frequencies_scalar(data, size);
+    }
+}
+
+/* adds the counts of `from` into `into`, e.g. to train one table on many samples */
+inline void merge_frequencies(FrequencyTable& into, const FrequencyTable& from) {
+    for (std::size_t symbol = 0; symbol < into.size(); ++symbol) {
+        into[symbol] += from[symbol];
+    }
+}
+
+/* number of distinct symbols present */
+inline std::size_t count_symbols(const FrequencyTable& frequency_table) {
+    std::size_t symbols = 0;
+    for (std::uint64_t frequency : frequency_table) {
+        symbols += frequency != 0;
+    }
+    return symbols;
+}
+
+#endif
@@ -1,179 +1,283 @@
 #ifndef HUFFMAN_H
 #define HUFFMAN_H
 
-#include "./BinaryTree.h"
+#include "./BitPacking.h"
+#include "./BitStream.h"
+#include "./Block.h"
+#include "./CanonicalCode.h"
+#include "./CodeTable.h"
+#include "./DecodeTable.h"
 #include "./Decoder.h"
-#include "unordered_map"
-#include <algorithm>
-#include <iostream>
-#include <queue>
-
-/* looks a little bit awful in this file and in general */
-struct NodeValue {
-    std::string str;
-    long long freq;
-};
-using NodePtr = std::unique_ptr<Node<NodeValue>>;
-
-inline auto node_comparator = [](const NodePtr& a, const NodePtr& b) {
-    return a->value.freq > b->value.freq;
-};
+#include "./Histogram.h"
+#include "./HuffmanTree.h"
+#include "./PackageMerge.h"
+#include "./SpanBuffer.h"
+#include "./Stats.h"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
-using FrequencyTable = std::unordered_map<char, long long>;
-using NodeMinPQ = std::priority_queue<NodePtr, std::vector<NodePtr>, decltype(node_comparator)>;
 using EncodingTable = std::unordered_map<std::string, std::string>;
 
+/*
+ * Everything encode and decode read, built once and never modified after
+ * construction. Huffman instances hold it through a shared_ptr<const>, so
+ * copies and instances made from get_tables() share one set of tables.
+ */
+struct HuffmanTables {
+    CodeTable code_table;
+    /* one '0'/'1' string per present byte, for the bit string debug view only */
+    EncodingTable direct_encoding_table;
+    /* the code length header and the stream count every encoded block starts with */
+    std::string header;
+
+    explicit HuffmanTables(CodeTable table)
+        : code_table(std::move(table)) {
+        for (const PrefixCode& code : assign_canonical_codes(code_table.get_code_lengths())) {
+            std::string code_str;
+            for (unsigned bit = code.length; bit > 0; --bit) {
+                code_str.push_back((code.code >> (bit - 1)) & 1 ? '1' : '0');
+            }
+            direct_encoding_table[std::string(1, static_cast<char>(code.symbol))] = code_str;
+        }
+        write_code_lengths(code_table.get_code_lengths(), header);
+        header.push_back(1);
+    }
+};
+
+/*
+ * encode() and decode() are const and only read the shared tables, so one
+ * instance can serve any number of threads at once.
+ */
 class Huffman : public Decoder {
     /* Outer handles */
 public:
-    NodePtr huffman_tree;
-
-    explicit Huffman(std::string text)
-        : Decoder(std::move(text)) {
-        huffman_tree = build_huffman_tree();
-
-        std::string code_buffer;
-        build_encoding_table(huffman_tree.get(), code_buffer);
-        for (const auto& [symbol, code] : direct_encoding_table) {
-            reversed_encoding_table[code] = symbol;
+    HuffmanTree huffman_tree;
+
+    /*
+     * Trains on `text` without keeping it. Codes longer than
+     * `code_length_limit` bits are avoided by falling back to package-merge.
+     */
+    explicit Huffman(const std::string& text, unsigned code_length_limit = max_code_length) {
+        {
+            StatsRecorder::Timer timer(stats, Stage::histogram);
+            frequency_table = count_frequencies(text.data(), text.size());
+        }
+        CodeLengths lengths;
+        {
+            StatsRecorder::Timer timer(stats, Stage::tree);
+            huffman_tree = HuffmanTree(frequency_table);
+            lengths = limit_code_lengths(frequency_table, huffman_tree.code_lengths(), code_length_limit);
+        }
+        {
+            StatsRecorder::Timer timer(stats, Stage::table);
+            tables = std::make_shared<const HuffmanTables>(CodeTable(lengths));
+        }
+        stats.add_table();
+        if constexpr (stats_enabled) {
+            record_code_quality(text.size());
         }
     }
 
-    std::string encode(std::string& text) override {
-        std::string decoded;
-        for (char ch : text) {
-            std::string str_to_decode = std::string(1, ch);
-            decoded += direct_encoding_table[str_to_decode];
-        }
-        return decoded;
+    /* wraps an already trained (e.g. deserialized) table; there is no tree or histogram then */
+    explicit Huffman(CodeTable table) {
+        StatsRecorder::Timer timer(stats, Stage::table);
+        tables = std::make_shared<const HuffmanTables>(std::move(table));
+        stats.add_table();
     }
 
-    std::string decode(std::string& text) override {
-        std::string decoded;
-        std::string encoding;
+    /* shares the tables of another instance without building anything */
+    explicit Huffman(std::shared_ptr<const HuffmanTables> shared_tables)
+        : tables(std::move(shared_tables)) {
+    }
 
-        for (char bit : text) {
-            encoding += bit;
+    /*
+     * Output is a single-stream block (see Block.h): code length header,
+     * stream count, the packed bitstream and one trailer byte holding the
+     * number of valid bits in the last packed byte, so any Huffman instance
+     * can decode it. Empty input, and input with a byte the training text
+     * lacked (which the span overload rejects), encode to "".
+     */
+    std::string encode(const std::string& text) const override {
+        std::string encoded;
+        if (text.empty()) {
+            return encoded;
+        }
 
-            if (reversed_encoding_table.count(encoding)) {
-                decoded += reversed_encoding_table[encoding];
-                encoding.clear();
-            }
+        StatsRecorder::Timer timer(stats, Stage::encode);
+        const CodeTable& table = tables->code_table;
+        if (!table.can_encode(text.data(), text.size())) {
+            return encoded;
         }
+        encoded.reserve(text.size() / 2 + 64);
+        encoded += tables->header;
 
-        return decoded;
-    }
+        BitWriter writer(encoded);
+        pack_symbols_flat(table.get_encode_table(), text.data(), text.size(), writer);
+        encoded.push_back(static_cast<char>(writer.finish()));
 
-    /* getters for testing purposes */
-    FrequencyTable get_frequency_table() const {
-        return create_frequency_table();
-    }
-    NodeMinPQ get_node_min_pq() const {
-        return create_node_min_pq();
-    }
-    EncodingTable get_encoding_table() const {
-        return direct_encoding_table;
+        stats.add_encoded(text.size(), encoded.size());
+        return encoded;
     }
 
-    /* Inner machinery */
-private:
-    EncodingTable direct_encoding_table;
-    EncodingTable reversed_encoding_table;
-
-    void build_encoding_table(const Node<NodeValue>* node, std::string& code) {
-        if (!node) {
-            return;
+    std::string decode(const std::string& text) const override {
+        std::string decoded;
+        BlockView block;
+        if (!parse_block(text.data(), text.size(), block)) {
+            return decoded;
         }
 
-        bool is_leaf = !node->get_left() && !node->get_right();
+        StatsRecorder::Timer timer(stats, Stage::decode);
+        /* streams produced by another table need their own decoder, built from the header alone */
+        CodeTable foreign_table;
+        const CodeTable& table = table_for(block, foreign_table);
 
-        if (is_leaf) {
-            auto element_to_encode = node->value.str;
-            direct_encoding_table[element_to_encode] = code;
-            return;
+        for (unsigned i = 0; i < block.stream_count; ++i) {
+            const BitstreamView& stream = block.streams[i];
+            if (!table.decode(stream.packed, stream.packed_size + 1, decoded)) {
+                return {};
+            }
         }
 
-        if (node->get_left()) {
-            code.push_back('0');
-            build_encoding_table(node->get_left(), code);
-            code.pop_back();
-        }
-        if (node->get_right()) {
-            code.push_back('1');
-            build_encoding_table(node->get_right(), code);
-            code.pop_back();
-        }
+        stats.add_decoded(decoded.size());
+        return decoded;
     }
 
-    NodePtr build_huffman_tree() const {
-        NodeMinPQ min_pq = create_node_min_pq();
-
-        if (min_pq.empty()) {
-            return nullptr;
+    /* allocates nothing unless `text` was encoded with a different table */
+    bool encode(std::span<const std::byte> text, std::span<std::byte> out, std::size_t& written) const override {
+        written = 0;
+        if (text.empty()) {
+            return true;
         }
 
-        if (min_pq.size() == 1) {
-            NodeValue dummy_value{ "dummy_root", 0 };
-            NodePtr parent = std::make_unique<Node<NodeValue>>(std::move(dummy_value));
-            NodePtr only_node = std::move(const_cast<NodePtr&>(min_pq.top()));
-            min_pq.pop();
-
-            parent->left = std::move(only_node);
-
-            return parent;
+        StatsRecorder::Timer timer(stats, Stage::encode);
+        SpanBuffer encoded(out);
+        encoded.append(tables->header.data(), tables->header.size());
+        if (!tables->code_table.encode(reinterpret_cast<const char*>(text.data()), text.size(), encoded) ||
+            encoded.overflowed()) {
+            return false;
         }
+        written = encoded.size();
+        stats.add_encoded(text.size(), written);
+        return true;
+    }
 
-        while (min_pq.size() > 1) {
-            NodePtr left = std::move(const_cast<NodePtr&>(min_pq.top()));
-            min_pq.pop();
-            NodePtr right = std::move(const_cast<NodePtr&>(min_pq.top()));
-            min_pq.pop();
+    bool decode(std::span<const std::byte> text, std::span<std::byte> out, std::size_t& written) const override {
+        written = 0;
+        if (text.empty()) {
+            return true;
+        }
 
-            /* tree will be determined with the order of nodes */
-            std::sort(left->value.str.begin(), left->value.str.end());
-            std::sort(right->value.str.begin(), right->value.str.end());
+        BlockView block;
+        if (!parse_block(reinterpret_cast<const char*>(text.data()), text.size(), block)) {
+            return false;
+        }
 
-            std::string merged_str = left->value.str + right->value.str;
-            std::sort(merged_str.begin(), merged_str.end());
+        StatsRecorder::Timer timer(stats, Stage::decode);
+        CodeTable foreign_table;
+        const CodeTable& table = table_for(block, foreign_table);
+
+        auto* decoded = reinterpret_cast<char*>(out.data());
+        for (unsigned i = 0; i < block.stream_count; ++i) {
+            const BitstreamView& stream = block.streams[i];
+            std::size_t stream_written = 0;
+            bool complete = table.decode(
+                stream.packed, stream.packed_size + 1, decoded + written, out.size() - written, stream_written);
+            written += stream_written;
+            if (!complete) {
+                return false;
+            }
+        }
+        stats.add_decoded(written);
+        return true;
+    }
 
-            long long combined_freq = left->value.freq + right->value.freq;
-            NodeValue merged_value{ merged_str, combined_freq };
-            NodePtr parent = std::make_unique<Node<NodeValue>>(std::move(merged_value));
+    /* header, stream count, then the bitstream and trailer at the longest code per byte */
+    std::size_t max_encoded_size(std::size_t size) const override {
+        return size ? tables->header.size() + tables->code_table.max_encoded_size(size) : 0;
+    }
 
-            /* smaller string will be in the left part */
-            if (left->value.str < right->value.str) {
-                parent->left = std::move(left);
-                parent->right = std::move(right);
-            } else {
-                parent->left = std::move(right);
-                parent->right = std::move(left);
+    /* debug view: one '0'/'1' character per bit */
+    std::string encode_bit_string(const std::string& text) const {
+        std::string encoded;
+        for (char ch : text) {
+            auto code = tables->direct_encoding_table.find(std::string(1, ch));
+            if (code != tables->direct_encoding_table.end()) {
+                encoded += code->second;
             }
+        }
+        return encoded;
+    }
 
-            min_pq.push(std::move(parent));
+    std::string decode_bit_string(const std::string& bits) const {
+        std::string packed;
+        BitWriter writer(packed);
+        for (char bit : bits) {
+            writer.write(bit == '1', 1);
         }
+        packed.push_back(static_cast<char>(writer.finish()));
 
-        return std::move(const_cast<NodePtr&>(min_pq.top()));
+        std::string decoded;
+        tables->code_table.decode(packed.data(), packed.size(), decoded);
+        return decoded;
     }
 
-    NodeMinPQ create_node_min_pq() const {
-        FrequencyTable frequency_table = create_frequency_table();
-        NodeMinPQ node_min_pq(node_comparator);
+    /* getters for testing purposes */
+    const FrequencyTable& get_frequency_table() const {
+        return frequency_table;
+    }
+    EncodingTable get_encoding_table() const {
+        return tables->direct_encoding_table;
+    }
+    const CodeLengths& get_code_lengths() const {
+        return tables->code_table.get_code_lengths();
+    }
+    const CodeTable& get_code_table() const {
+        return tables->code_table;
+    }
+    const std::shared_ptr<const HuffmanTables>& get_tables() const {
+        return tables;
+    }
 
-        for (const auto& [ch, frequency] : frequency_table) {
-            NodePtr node_ptr =
-                std::make_unique<Node<NodeValue>>(NodeValue{ std::string(1, ch), frequency });
-            node_min_pq.push(std::move(node_ptr));
-        }
+    /* per-stage timings and counters; all zero unless built with HUFFMAN_STATS */
+    HuffmanStats get_stats() const {
+        return stats.snapshot();
+    }
+    void reset_stats() {
+        stats.reset();
+    }
 
-        return node_min_pq;
+    /* Inner machinery */
+private:
+    FrequencyTable frequency_table{};
+    std::shared_ptr<const HuffmanTables> tables;
+    mutable StatsRecorder stats;
+
+    /* the trained table if the block was coded with it, otherwise one built into `foreign_table` */
+    const CodeTable& table_for(const BlockView& block, CodeTable& foreign_table) const {
+        if (block.lengths == tables->code_table.get_code_lengths()) {
+            return tables->code_table;
+        }
+        foreign_table = CodeTable(block.lengths);
+        stats.add_table();
+        stats.add_table_miss();
+        return foreign_table;
     }
 
-    FrequencyTable create_frequency_table() const {
-        std::unordered_map<char, long long> frequency_table;
-        for (char ch : text_to_decode) {
-            frequency_table[ch]++;
+    void record_code_quality(std::size_t size) {
+        if (size == 0) {
+            return;
         }
-        return frequency_table;
+        const CodeLengths& lengths = tables->code_table.get_code_lengths();
+        double bits = 0;
+        for (std::size_t symbol = 0; symbol < frequency_table.size(); ++symbol) {
+            bits += static_cast<double>(frequency_table[symbol]) * lengths[symbol];
+        }
+        stats.set_code_quality(bits / static_cast<double>(size),
+                               entropy_bits(frequency_table, size) / static_cast<double>(size));
     }
 };
 
@@ -0,0 +1,191 @@
+#ifndef HUFFMAN_TREE_H
+#define HUFFMAN_TREE_H
+
+#include "./CanonicalCode.h"
+#include "./Histogram.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* `left`/`right` are arena indices, -1 on leaves; `symbol` is only meaningful on leaves */
+struct TreeNode {
+    std::uint64_t freq = 0;
+    std::int16_t left = -1;
+    std::int16_t right = -1;
+    std::uint16_t symbol = 0;
+
+    bool is_leaf() const {
+        return left < 0 && right < 0;
+    }
+};
+
+/*
+ * Huffman tree over a flat arena. The leaves occupy the front of the arena,
+ * sorted by (frequency, symbol), and the internal nodes follow in creation
+ * order. Both runs are non-decreasing in frequency, so they serve as the two
+ * queues of the linear-time merge: each step takes the two smallest fronts,
+ * a leaf winning ties against an internal node.
+ */
+class HuffmanTree {
+public:
+    static constexpr std::size_t max_nodes = 2 * 256 - 1;
+
+    HuffmanTree() = default;
+
+    explicit HuffmanTree(const FrequencyTable& frequency_table) {
+        for (std::size_t symbol = 0; symbol < frequency_table.size(); ++symbol) {
+            if (frequency_table[symbol]) {
+                TreeNode& leaf = nodes[leaf_count++];
+                leaf.freq = frequency_table[symbol];
+                leaf.symbol = static_cast<std::uint16_t>(symbol);
+            }
+        }
+        node_count = leaf_count;
+
+        std::sort(nodes.begin(), nodes.begin() + leaf_count, [](const TreeNode& a, const TreeNode& b) {
+            return a.freq != b.freq ? a.freq < b.freq : a.symbol < b.symbol;
+        });
+
+        if (leaf_count == 0) {
+            return;
+        }
+        if (leaf_count == 1) {
+            TreeNode& root = nodes[node_count++];
+            root.freq = nodes[0].freq;
+            root.left = 0;
+            return;
+        }
+
+        std::size_t next_leaf = 0;
+        std::size_t next_internal = leaf_count;
+        auto take_smallest = [&]() -> std::int16_t {
+            bool leaf_available = next_leaf < leaf_count;
+            bool internal_available = next_internal < node_count;
+            if (leaf_available &&
+                (!internal_available || nodes[next_leaf].freq <= nodes[next_internal].freq)) {
+                return static_cast<std::int16_t>(next_leaf++);
+            }
+            return static_cast<std::int16_t>(next_internal++);
+        };
+
+        while (node_count < 2 * leaf_count - 1) {
+            std::int16_t left = take_smallest();
+            std::int16_t right = take_smallest();
+
+            TreeNode& parent = nodes[node_count++];
+            parent.freq = nodes[left].freq + nodes[right].freq;
+            parent.left = left;
+            parent.right = right;
+        }
+    }
+
+    bool empty() const {
+        return node_count == 0;
+    }
+    std::size_t size() const {
+        return node_count;
+    }
+    std::size_t leaves() const {
+        return leaf_count;
+    }
+
+    /* leaves come first in the arena, sorted by (frequency, symbol) */
+    const TreeNode& operator[](std::size_t index) const {
+        return nodes[index];
+    }
+    const TreeNode& root() const {
+        return nodes[node_count - 1];
+    }
+
+    /* children always precede their parent, so one backwards sweep assigns every depth */
+    CodeLengths code_lengths() const {
+        CodeLengths lengths{};
+        if (empty()) {
+            return lengths;
+        }
+
+        std::array<std::uint16_t, max_nodes> depth{};
+        for (std::size_t i = node_count; i-- > leaf_count;) {
+            for (std::int16_t child : { nodes[i].left, nodes[i].right }) {
+                if (child >= 0) {
+                    depth[child] = depth[i] + 1;
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < leaf_count; ++i) {
+            lengths[nodes[i].symbol] = static_cast<std::uint8_t>(depth[i]);
+        }
+        return lengths;
+    }
+
+private:
+    std::array<TreeNode, max_nodes> nodes{};
+    std::size_t leaf_count = 0;
+    std::size_t node_count = 0;
+};
+
+/*
+ * The same merge for alphabets of any size, where the byte-sized arena does
+ * not fit: returns the depth of every symbol of `weights` (0 where the weight
+ * is 0). Depths are not capped, see package_merge_code_lengths.
+ */
+inline std::vector<std::uint32_t> huffman_code_depths(const std::vector<std::uint64_t>& weights) {
+    std::vector<std::uint32_t> order;
+    for (std::uint32_t symbol = 0; symbol < weights.size(); ++symbol) {
+        if (weights[symbol]) {
+            order.push_back(symbol);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return weights[a] != weights[b] ? weights[a] < weights[b] : a < b;
+    });
+
+    std::vector<std::uint32_t> depths(weights.size());
+    std::size_t leaf_count = order.size();
+    if (leaf_count == 1) {
+        depths[order[0]] = 1;
+    }
+    if (leaf_count < 2) {
+        return depths;
+    }
+
+    /* nodes 0 .. leaf_count - 1 are the sorted leaves, internal nodes follow */
+    std::vector<std::uint64_t> freq(2 * leaf_count - 1);
+    std::vector<std::uint32_t> parent(2 * leaf_count - 1);
+    for (std::size_t i = 0; i < leaf_count; ++i) {
+        freq[i] = weights[order[i]];
+    }
+
+    std::size_t next_leaf = 0;
+    std::size_t next_internal = leaf_count;
+    std::size_t node_count = leaf_count;
+    auto take_smallest = [&]() -> std::size_t {
+        if (next_leaf < leaf_count && (next_internal == node_count || freq[next_leaf] <= freq[next_internal])) {
+            return next_leaf++;
+        }
+        return next_internal++;
+    };
+
+    while (node_count < freq.size()) {
+        std::size_t left = take_smallest();
+        std::size_t right = take_smallest();
+        freq[node_count] = freq[left] + freq[right];
+        parent[left] = parent[right] = static_cast<std::uint32_t>(node_count);
+        ++node_count;
+    }
+
+    /* parents always follow their children, so one backwards sweep assigns every depth */
+    std::vector<std::uint32_t> node_depth(node_count);
+    for (std::size_t i = node_count - 1; i-- > 0;) {
+        node_depth[i] = node_depth[parent[i]] + 1;
+    }
+    for (std::size_t i = 0; i < leaf_count; ++i) {
+        depths[order[i]] = node_depth[i];
+    }
+    return depths;
+}
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef IO_QUEUE_H
+#define IO_QUEUE_H
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HUFFMAN_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+enum class IoBackend { automatic, io_uring, threads };
+
+/* `result` is the byte count of a read or write, or -errno */
+struct IoCompletion {
+    std::uint64_t tag;
+    long result;
+};
+
+/*
+ * Asynchronous positioned reads and writes. Every request, and every post()
+ * from another thread, comes back exactly once through wait(), tagged with
+ * the caller's `tag`; a request may transfer fewer bytes than asked for.
+ * Requests are issued from one thread.
+ */
+class IoQueue {
+public:
+    virtual ~IoQueue() = default;
+
+    /* `buffer` is the index of `data`'s registered buffer, or -1 */
+    virtual void read(int fd, char* data, std::size_t size, std::uint64_t offset, int buffer, std::uint64_t tag) = 0;
+    virtual void write(int fd, const char* data, std::size_t size, std::uint64_t offset, std::uint64_t tag) = 0;
+    virtual const char* name() const = 0;
+
+    /* thread-safe: lets other stages (e.g. compression tasks) report through the same queue */
+    void post(std::uint64_t tag, long result) {
+        /* notified under the lock: the last completion may let the owner destroy the queue */
+        std::lock_guard<std::mutex> lock(mutex);
+        completions.push_back({ tag, result });
+        ready.notify_one();
+    }
+
+    IoCompletion wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return !completions.empty(); });
+        IoCompletion completion = completions.front();
+        completions.pop_front();
+        return completion;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<IoCompletion> completions;
+};
+
+/* the fallback: blocking pread/pwrite on a few dedicated threads */
+class ThreadIoQueue : public IoQueue {
+public:
+    explicit ThreadIoQueue(unsigned threads = 2) {
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~ThreadIoQueue() override {
+        {
+            std::lock_guard<std::mutex> lock(request_mutex);
+            stopping = true;
+        }
+        request_ready.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void read(int fd, char* data, std::size_t size, std::uint64_t offset, int, std::uint64_t tag) override {
+        enqueue({ fd, data, size, offset, tag, false });
+    }
+
+    void write(int fd, const char* data, std::size_t size, std::uint64_t offset, std::uint64_t tag) override {
+        enqueue({ fd, const_cast<char*>(data), size, offset, tag, true });
+    }
+
+    const char* name() const override {
+        return "pread";
+    }
+
+private:
+    struct Request {
+        int fd;
+        char* data;
+        std::size_t size;
+        std::uint64_t offset;
+        std::uint64_t tag;
+        bool is_write;
+    };
+
+    std::mutex request_mutex;
+    std::condition_variable request_ready;
+    std::deque<Request> requests;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void enqueue(Request request) {
+        {
+            std::lock_guard<std::mutex> lock(request_mutex);
+            requests.push_back(request);
+        }
+        request_ready.notify_one();
+    }
+
+    void worker_loop() {
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(request_mutex);
+                request_ready.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (requests.empty()) {
+                    return;
+                }
+                request = requests.front();
+                requests.pop_front();
+            }
+
+            ssize_t done;
+            do {
+                done = request.is_write
+                           ? ::pwrite(request.fd, request.data, request.size, static_cast<off_t>(request.offset))
+                           : ::pread(request.fd, request.data, request.size, static_cast<off_t>(request.offset));
+            } while (done < 0 && errno == EINTR);
+            post(request.tag, done < 0 ? -errno : static_cast<long>(done));
+        }
+    }
+};
+
+#ifdef HUFFMAN_IO_URING
+
+/*
+ * io_uring through the raw system calls (no liburing): the issuing thread
+ * fills submission entries and enters the ring, a reaper thread blocks for
+ * completions and forwards them to wait(). Reads into registered buffers use
+ * IORING_OP_READ_FIXED, which skips pinning the pages on every request. The
+ * opcodes are probed up front, so a kernel that has io_uring but not these
+ * operations (or not READ_FIXED) falls back before the first request fails.
+ */
+class UringIoQueue : public IoQueue {
+public:
+    /* check ok() afterwards: the kernel may lack io_uring or forbid it */
+    UringIoQueue(unsigned depth, const std::vector<iovec>& buffers) {
+        io_uring_params params{};
+        ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, depth, &params));
+        if (ring_fd < 0) {
+            return;
+        }
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_size = cq_size = std::max(sq_size, cq_size);
+        }
+
+        sq_ring = map(sq_size, IORING_OFF_SQ_RING);
+        cq_ring = single_mmap ? sq_ring : map(cq_size, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+        if (!sq_ring || !cq_ring || !sqes) {
+            return;
+        }
+
+        auto* sq = static_cast<char*>(sq_ring);
+        auto* cq = static_cast<char*>(cq_ring);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        /* a ring the kernel cannot read or write through is no better than none */
+        std::vector<char> probe_space(sizeof(io_uring_probe) + max_probe_ops * sizeof(io_uring_probe_op));
+        auto* probe = reinterpret_cast<io_uring_probe*>(probe_space.data());
+        if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, max_probe_ops) != 0 ||
+            !supported(*probe, IORING_OP_READ) || !supported(*probe, IORING_OP_WRITE)) {
+            return;
+        }
+
+        if (!buffers.empty() && supported(*probe, IORING_OP_READ_FIXED)) {
+            registered = ::syscall(__NR_io_uring_register,
+                                   ring_fd,
+                                   IORING_REGISTER_BUFFERS,
+                                   buffers.data(),
+                                   static_cast<unsigned>(buffers.size())) == 0;
+        }
+
+        reaper = std::thread([this] { reap_loop(); });
+        usable = true;
+    }
+
+    ~UringIoQueue() override {
+        if (reaper.joinable()) {
+            submit([](io_uring_sqe& sqe) { sqe.opcode = IORING_OP_NOP; }, stop_tag);
+            reaper.join();
+        }
+        if (sqes) {
+            ::munmap(sqes, sqes_size);
+        }
+        if (cq_ring && !single_mmap) {
+            ::munmap(cq_ring, cq_size);
+        }
+        if (sq_ring) {
+            ::munmap(sq_ring, sq_size);
+        }
+        if (ring_fd >= 0) {
+            ::close(ring_fd);
+        }
+    }
+
+    bool ok() const {
+        return usable;
+    }
+
+    void read(int fd, char* data, std::size_t size, std::uint64_t offset, int buffer, std::uint64_t tag) override {
+        submit(
+            [&](io_uring_sqe& sqe) {
+                sqe.opcode = registered && buffer >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(data);
+                sqe.len = static_cast<std::uint32_t>(size);
+                sqe.off = offset;
+                sqe.buf_index = static_cast<std::uint16_t>(buffer >= 0 ? buffer : 0);
+            },
+            tag);
+    }
+
+    void write(int fd, const char* data, std::size_t size, std::uint64_t offset, std::uint64_t tag) override {
+        submit(
+            [&](io_uring_sqe& sqe) {
+                sqe.opcode = IORING_OP_WRITE;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(data);
+                sqe.len = static_cast<std::uint32_t>(size);
+                sqe.off = offset;
+            },
+            tag);
+    }
+
+    const char* name() const override {
+        return "io_uring";
+    }
+
+private:
+    static constexpr std::uint64_t stop_tag = ~std::uint64_t{ 0 };
+    static constexpr unsigned max_probe_ops = 256;
+
+    int ring_fd = -1;
+    bool usable = false;
+    bool registered = false;
+    bool single_mmap = false;
+    std::size_t sq_size = 0;
+    std::size_t cq_size = 0;
+    std::size_t sqes_size = 0;
+    void* sq_ring = nullptr;
+    void* cq_ring = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+    unsigned sq_entries = 0;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+    std::thread reaper;
+
+    static bool supported(const io_uring_probe& probe, unsigned opcode) {
+        return opcode < probe.ops_len && (probe.ops[opcode].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    void* map(std::size_t size, std::uint64_t offset) {
+        void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+        return address == MAP_FAILED ? nullptr : address;
+    }
+
+    /* every entry is entered right away, so the ring never fills while the kernel keeps up */
+    template <typename Fill>
+    void submit(Fill fill, std::uint64_t tag) {
+        unsigned tail = *sq_tail;
+        if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == sq_entries) {
+            post(tag, -EBUSY);
+            return;
+        }
+
+        unsigned index = tail & sq_mask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        fill(sqe);
+        sqe.user_data = tag;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        long entered;
+        do {
+            entered = ::syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, nullptr, 0);
+        } while (entered < 0 && errno == EINTR);
+        if (entered < 0 && tag != stop_tag) {
+            post(tag, -errno);
+        }
+    }
+
+    void reap_loop() {
+        while (true) {
+            long waited = ::syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (waited < 0 && errno != EINTR) {
+                return;
+            }
+
+            bool stop = false;
+            unsigned head = *cq_head;
+            unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes[head & cq_mask];
+                if (cqe.user_data == stop_tag) {
+                    stop = true;
+                } else {
+                    post(cqe.user_data, cqe.res);
+                }
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+            if (stop) {
+                return;
+            }
+        }
+    }
+};
+
+#endif
+
+/* io_uring when asked for (or automatic) and usable here, the thread fallback otherwise */
+inline std::unique_ptr<IoQueue> make_io_queue(IoBackend backend, unsigned depth, const std::vector<iovec>& buffers) {
+#ifdef HUFFMAN_IO_URING
+    if (backend != IoBackend::threads) {
+        auto uring = std::make_unique<UringIoQueue>(depth, buffers);
+        if (uring->ok()) {
+            return uring;
+        }
+    }
+#endif
+    (void)depth;
+    (void)buffers;
+    return std::make_unique<ThreadIoQueue>();
+}
+
+#endif
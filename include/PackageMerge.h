@@ -0,0 +1,120 @@
+#ifndef PACKAGE_MERGE_H
+#define PACKAGE_MERGE_H
+
+#include "./CanonicalCode.h"
+#include "./Histogram.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* smallest limit that can still give every present symbol its own code */
+inline unsigned min_code_length_limit(std::size_t symbols) {
+    unsigned limit = 1;
+    while ((std::size_t{ 1 } << limit) < symbols) {
+        ++limit;
+    }
+    return limit;
+}
+
+/* all-zero code lengths indexed like `frequencies` */
+inline CodeLengths empty_code_lengths(const FrequencyTable&) {
+    return {};
+}
+inline std::vector<std::uint8_t> empty_code_lengths(const std::vector<std::uint64_t>& frequencies) {
+    return std::vector<std::uint8_t>(frequencies.size());
+}
+
+/*
+ * Optimal code lengths bounded by `limit` (package-merge). Every level holds
+ * the leaves merged with pairs ("packages") of the level below, both sorted by
+ * weight; the 2n - 2 cheapest items of the top level are then expanded back
+ * down, and each time a leaf is met its code gets one bit longer.
+ * `limit` is raised to min_code_length_limit() when it is too small.
+ */
+template <typename Frequencies>
+auto package_merge_code_lengths(const Frequencies& frequency_table, unsigned limit) {
+    struct Item {
+        std::uint64_t weight;
+        std::int32_t symbol;   // -1 for packages
+        std::int32_t first;    // packages: index of the first child in the level below
+    };
+
+    std::vector<Item> leaves;
+    for (std::size_t symbol = 0; symbol < frequency_table.size(); ++symbol) {
+        if (frequency_table[symbol]) {
+            leaves.push_back(Item{ frequency_table[symbol], static_cast<std::int32_t>(symbol), -1 });
+        }
+    }
+    std::sort(leaves.begin(), leaves.end(), [](const Item& a, const Item& b) {
+        return a.weight != b.weight ? a.weight < b.weight : a.symbol < b.symbol;
+    });
+
+    auto lengths = empty_code_lengths(frequency_table);
+    if (leaves.size() == 1) {
+        lengths[leaves[0].symbol] = 1;
+    }
+    if (leaves.size() < 2) {
+        return lengths;
+    }
+
+    limit = std::max(limit, min_code_length_limit(leaves.size()));
+    limit = std::min(limit, max_code_length);
+
+    std::vector<std::vector<Item>> levels(limit);
+    levels[0] = leaves;
+    for (unsigned level = 1; level < limit; ++level) {
+        const std::vector<Item>& below = levels[level - 1];
+        std::vector<Item>& current = levels[level];
+        current.reserve(leaves.size() + below.size() / 2);
+
+        std::size_t next_leaf = 0;
+        std::size_t next_pair = 0;
+        while (next_leaf < leaves.size() || next_pair + 1 < below.size()) {
+            bool pair_available = next_pair + 1 < below.size();
+            std::uint64_t pair_weight =
+                pair_available ? below[next_pair].weight + below[next_pair + 1].weight : 0;
+
+            if (next_leaf < leaves.size() &&
+                (!pair_available || leaves[next_leaf].weight <= pair_weight)) {
+                current.push_back(leaves[next_leaf++]);
+            } else {
+                current.push_back(Item{ pair_weight, -1, static_cast<std::int32_t>(next_pair) });
+                next_pair += 2;
+            }
+        }
+    }
+
+    /* (level, index) pairs still to expand */
+    std::vector<std::pair<unsigned, std::int32_t>> pending;
+    for (std::size_t i = 0; i < 2 * leaves.size() - 2; ++i) {
+        pending.emplace_back(limit - 1, static_cast<std::int32_t>(i));
+    }
+    while (!pending.empty()) {
+        auto [level, index] = pending.back();
+        pending.pop_back();
+
+        const Item& item = levels[level][index];
+        if (item.symbol >= 0) {
+            lengths[item.symbol]++;
+        } else {
+            pending.emplace_back(level - 1, item.first);
+            pending.emplace_back(level - 1, item.first + 1);
+        }
+    }
+
+    return lengths;
+}
+
+/* returns `lengths` unchanged when already within `limit`, otherwise the optimal limited lengths */
+inline CodeLengths limit_code_lengths(const FrequencyTable& frequency_table,
+                                      const CodeLengths& lengths,
+                                      unsigned limit) {
+    unsigned longest = *std::max_element(lengths.begin(), lengths.end());
+    if (longest <= limit) {
+        return lengths;
+    }
+    return package_merge_code_lengths(frequency_table, limit);
+}
+
+#endif
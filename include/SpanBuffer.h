@@ -0,0 +1,76 @@
+#ifndef SPAN_BUFFER_H
+#define SPAN_BUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+/*
+ * The subset of std::string the encoders append through, over a fixed
+ * caller-owned region. Bytes past the end of the region are dropped and
+ * overflowed() turns true; callers size the region from a bound (see
+ * max_compressed_size) so that never happens, which also keeps the
+ * positions patched through data() inside it.
+ */
+class SpanBuffer {
+public:
+    explicit SpanBuffer(std::span<std::byte> target)
+        : target(target) {
+    }
+
+    void push_back(char byte) {
+        if (used == target.size()) {
+            overflow = true;
+            return;
+        }
+        target[used++] = static_cast<std::byte>(byte);
+    }
+
+    void append(const char* data, std::size_t size) {
+        std::size_t fit = std::min(size, target.size() - used);
+        std::memcpy(target.data() + used, data, fit);
+        used += fit;
+        overflow = overflow || fit < size;
+    }
+
+    void append(std::size_t count, char byte) {
+        std::size_t fit = std::min(count, target.size() - used);
+        std::memset(target.data() + used, static_cast<unsigned char>(byte), fit);
+        used += fit;
+        overflow = overflow || fit < count;
+    }
+
+    void resize(std::size_t size) {
+        if (size < used) {
+            used = size;
+        } else {
+            append(size - used, '\0');
+        }
+    }
+
+    void clear() {
+        used = 0;
+        overflow = false;
+    }
+
+    char* data() {
+        return reinterpret_cast<char*>(target.data());
+    }
+    std::size_t size() const {
+        return used;
+    }
+    std::size_t capacity() const {
+        return target.size();
+    }
+    bool overflowed() const {
+        return overflow;
+    }
+
+private:
+    std::span<std::byte> target;
+    std::size_t used = 0;
+    bool overflow = false;
+};
+
+#endif
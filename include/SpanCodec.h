@@ -0,0 +1,65 @@
+#ifndef SPAN_CODEC_H
+#define SPAN_CODEC_H
+
+#include "./Block.h"
+#include "./ByteOrder.h"
+#include "./SpanBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/*
+ * One-shot compression between caller-owned buffers, e.g. straight out of and
+ * into network ring buffers. Compressed form: the varint uncompressed size,
+ * then one block (see Block.h), which never exceeds its input by more than a
+ * byte.
+ */
+inline constexpr std::size_t max_compressed_size(std::size_t raw_size) {
+    return max_varint_size + raw_size + 1;
+}
+
+/* false, writing nothing useful, unless `out` holds at least max_compressed_size(in.size()) bytes */
+inline bool compress(std::span<const std::byte> in,
+                     std::span<std::byte> out,
+                     std::size_t& written,
+                     unsigned stream_count = 4,
+                     unsigned code_length_limit = max_code_length) {
+    written = 0;
+    if (out.size() < max_compressed_size(in.size())) {
+        return false;
+    }
+
+    SpanBuffer compressed(out);
+    append_varint(compressed, in.size());
+    encode_block(reinterpret_cast<const char*>(in.data()), in.size(), compressed, code_length_limit, stream_count);
+    written = compressed.size();
+    return !compressed.overflowed();
+}
+
+/* the size decompress() needs for its output; false if `in` does not start like compressed data */
+inline bool decompressed_size(std::span<const std::byte> in, std::uint64_t& size) {
+    std::size_t pos = 0;
+    return read_varint(reinterpret_cast<const char*>(in.data()), in.size(), pos, size);
+}
+
+/* false if `in` is malformed or its content does not fit in `out` */
+inline bool decompress(std::span<const std::byte> in, std::span<std::byte> out, std::size_t& written) {
+    written = 0;
+    const auto* data = reinterpret_cast<const char*>(in.data());
+    std::size_t pos = 0;
+    std::uint64_t raw_size = 0;
+    if (!read_varint(data, in.size(), pos, raw_size) || raw_size > out.size()) {
+        return false;
+    }
+    if (raw_size == 0) {
+        return pos == in.size();
+    }
+
+    if (!decode_block(data + pos, in.size() - pos, reinterpret_cast<char*>(out.data()), raw_size)) {
+        return false;
+    }
+    written = raw_size;
+    return true;
+}
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef STATIC_HUFFMAN_H
+#define STATIC_HUFFMAN_H
+
+#include "./BitPacking.h"
+#include "./Block.h"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+ * A symbol distribution known when the program is compiled:
+ *
+ *   struct DnsProfile {
+ *       static constexpr FrequencyTable frequencies = { ... };
+ *       static constexpr unsigned code_length_limit = 11;   // optional, 12 if absent
+ *   };
+ */
+template <typename Profile>
+concept FrequencyProfile = requires {
+    { Profile::frequencies } -> std::convertible_to<const FrequencyTable&>;
+};
+
+namespace static_huffman_detail {
+
+inline constexpr unsigned default_code_length_limit = 12;
+
+/* one entry per `limit`-bit window: the symbol whose code starts it, 0 length if none does */
+struct DecodeEntry {
+    std::uint8_t symbol = 0;
+    std::uint8_t length = 0;
+};
+
+constexpr std::size_t count_present(const FrequencyTable& frequency_table) {
+    std::size_t present = 0;
+    for (std::uint64_t frequency : frequency_table) {
+        present += frequency != 0;
+    }
+    return present;
+}
+
+/*
+ * Huffman code lengths: the two-queue construction over the leaves sorted by
+ * frequency, then levels deeper than `limit` are folded upward with the
+ * adjustment of JPEG Annex K.3 and the lengths are handed out again, shortest
+ * to the most frequent symbol.
+ */
+constexpr CodeLengths build_code_lengths(const FrequencyTable& frequency_table, unsigned limit) {
+    std::array<std::uint32_t, 256> order{};
+    std::size_t n = 0;
+    for (std::uint32_t symbol = 0; symbol < 256; ++symbol) {
+        if (frequency_table[symbol]) {
+            order[n++] = symbol;
+        }
+    }
+    for (std::size_t i = 1; i < n; ++i) {
+        std::uint32_t key = order[i];
+        std::size_t j = i;
+        for (; j > 0 && frequency_table[order[j - 1]] > frequency_table[key]; --j) {
+            order[j] = order[j - 1];
+        }
+        order[j] = key;
+    }
+
+    CodeLengths lengths{};
+    if (n == 0) {
+        return lengths;
+    }
+    if (n == 1) {
+        lengths[order[0]] = 1;
+        return lengths;
+    }
+
+    /* nodes [0, n) are the sorted leaves, [n, 2n - 1) the merged nodes in creation order */
+    std::array<std::uint64_t, 511> weight{};
+    std::array<std::uint32_t, 511> parent{};
+    for (std::size_t i = 0; i < n; ++i) {
+        weight[i] = frequency_table[order[i]];
+    }
+    std::size_t leaf = 0;
+    std::size_t merged = n;
+    std::size_t next = n;
+    auto take = [&]() {
+        if (leaf < n && (merged == next || weight[leaf] <= weight[merged])) {
+            return leaf++;
+        }
+        return merged++;
+    };
+    for (; next < 2 * n - 1; ++next) {
+        std::size_t a = take();
+        std::size_t b = take();
+        weight[next] = weight[a] + weight[b];
+        parent[a] = parent[b] = static_cast<std::uint32_t>(next);
+    }
+
+    /* a parent is always created after its children, so one downward pass gives every depth */
+    std::array<std::uint32_t, 511> depth{};
+    std::array<std::uint32_t, 256> count{};
+    unsigned longest = 0;
+    for (std::size_t i = 2 * n - 2; i-- > 0;) {
+        depth[i] = depth[parent[i]] + 1;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        count[depth[i]]++;
+        longest = depth[i] > longest ? depth[i] : longest;
+    }
+
+    for (unsigned i = longest; i > limit; --i) {
+        while (count[i] > 0) {
+            unsigned j = i - 2;
+            while (count[j] == 0) {
+                --j;
+            }
+            count[i] -= 2;
+            count[i - 1] += 1;
+            count[j + 1] += 2;
+            count[j] -= 1;
+        }
+    }
+
+    std::size_t next_symbol = n;
+    for (unsigned length = 1; length <= limit; ++length) {
+        for (std::uint32_t i = 0; i < count[length]; ++i) {
+            lengths[order[--next_symbol]] = static_cast<std::uint8_t>(length);
+        }
+    }
+    return lengths;
+}
+
+/* the canonical codes of assign_canonical_codes(), indexed by symbol */
+constexpr EncodeTable build_encode_table(const CodeLengths& lengths) {
+    std::array<std::uint32_t, max_code_length + 1> length_count{};
+    for (std::uint8_t length : lengths) {
+        length_count[length]++;
+    }
+    length_count[0] = 0;
+
+    std::array<std::uint64_t, max_code_length + 1> next_code{};
+    std::uint64_t code = 0;
+    for (unsigned length = 1; length <= max_code_length; ++length) {
+        code = (code + length_count[length - 1]) << 1;
+        next_code[length] = code;
+    }
+
+    EncodeTable table{};
+    for (std::uint32_t symbol = 0; symbol < 256; ++symbol) {
+        unsigned length = lengths[symbol];
+        table[symbol] = PrefixCode{ symbol, length ? next_code[length]++ : 0, length };
+    }
+    return table;
+}
+
+template <unsigned Bits>
+constexpr std::array<DecodeEntry, std::size_t{ 1 } << Bits> build_decode_table(const EncodeTable& table) {
+    std::array<DecodeEntry, std::size_t{ 1 } << Bits> entries{};
+    for (const PrefixCode& code : table) {
+        if (code.length == 0) {
+            continue;
+        }
+        std::size_t first = static_cast<std::size_t>(code.code) << (Bits - code.length);
+        std::size_t span = std::size_t{ 1 } << (Bits - code.length);
+        for (std::size_t i = 0; i < span; ++i) {
+            entries[first + i] = DecodeEntry{ static_cast<std::uint8_t>(code.symbol),
+                                              static_cast<std::uint8_t>(code.length) };
+        }
+    }
+    return entries;
+}
+
+template <typename Profile>
+constexpr unsigned profile_code_length_limit() {
+    if constexpr (requires { Profile::code_length_limit; }) {
+        return Profile::code_length_limit;
+    } else {
+        return default_code_length_limit;
+    }
+}
+
+}   // namespace static_huffman_detail
+
+/*
+ * Encoder and decoder for a distribution fixed at compile time: the code
+ * lengths, the encode table and a single-level decode table are all
+ * constexpr, so nothing is built at startup and the tables live in read-only
+ * data at addresses the compiler knows.
+ *
+ * Messages use the CodeTable format, a bare bitstream plus its trailer byte
+ * (see Block.h), so CodeTable(code_lengths) reads and writes them too. Bytes
+ * the profile gives no frequency have no code and cannot be encoded.
+ */
+template <FrequencyProfile Profile>
+class StaticHuffman {
+    /* Outer handles */
+public:
+    static constexpr unsigned code_length_limit = static_huffman_detail::profile_code_length_limit<Profile>();
+    static_assert(code_length_limit >= 1 && code_length_limit <= 16,
+                  "the decode table has 2^code_length_limit entries");
+    static_assert(static_huffman_detail::count_present(Profile::frequencies) <= (std::size_t{ 1 } << code_length_limit),
+                  "code_length_limit is too small for the symbols in the profile");
+
+    static constexpr CodeLengths code_lengths =
+        static_huffman_detail::build_code_lengths(Profile::frequencies, code_length_limit);
+    static constexpr EncodeTable encode_table = static_huffman_detail::build_encode_table(code_lengths);
+
+    /* true if every byte of `data` has a code */
+    static bool can_encode(const char* data, std::size_t size) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+        unsigned missing = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            missing |= code_lengths[bytes[i]] == 0;
+        }
+        return missing == 0;
+    }
+
+    /* bytes encode() appends for `size` bytes of any input it accepts */
+    static constexpr std::size_t max_encoded_size(std::size_t size) {
+        return (size * flat_table.longest() + 7) / 8 + 1;
+    }
+
+    /* appends the message to `out` (std::string or SpanBuffer); false, appending nothing, if a byte has no code */
+    template <typename Out>
+    static bool encode(const char* data, std::size_t size, Out& out) {
+        if (!can_encode(data, size)) {
+            return false;
+        }
+        BitWriter writer(out);
+        pack_symbols_flat(flat_table, data, size, writer);
+        out.push_back(static_cast<char>(writer.finish()));
+        return true;
+    }
+
+    /* "" if a byte has no code; a valid message is never empty */
+    static std::string encode(std::string_view text) {
+        std::string out;
+        out.reserve(max_encoded_size(text.size()));
+        if (!encode(text.data(), text.size(), out)) {
+            return {};
+        }
+        return out;
+    }
+
+    /* appends the decoded message to `out`; false if the message is malformed */
+    static bool decode(const char* data, std::size_t size, std::string& out) {
+        BitstreamView stream;
+        if (!parse_bitstream(data, size, stream)) {
+            return false;
+        }
+
+        BitReader reader(stream.packed, stream.packed_size, stream.bit_count);
+        while (!reader.exhausted()) {
+            const auto& entry = decode_table[reader.peek(code_length_limit)];
+            if (entry.length == 0) {
+                return false;
+            }
+            reader.consume(entry.length);
+            out.push_back(static_cast<char>(entry.symbol));
+        }
+        return reader.consumed() == stream.bit_count;
+    }
+
+    /* decodes into `out`; false if the message is malformed or does not fit in `capacity` bytes */
+    static bool decode(const char* data, std::size_t size, char* out, std::size_t capacity, std::size_t& written) {
+        BitstreamView stream;
+        written = 0;
+        if (!parse_bitstream(data, size, stream)) {
+            return false;
+        }
+
+        BitReader reader(stream.packed, stream.packed_size, stream.bit_count);
+        while (!reader.exhausted()) {
+            const auto& entry = decode_table[reader.peek(code_length_limit)];
+            if (entry.length == 0 || written == capacity) {
+                return false;
+            }
+            reader.consume(entry.length);
+            out[written++] = static_cast<char>(entry.symbol);
+        }
+        return reader.consumed() == stream.bit_count;
+    }
+
+    /* Inner machinery */
+private:
+    static constexpr FlatEncodeTable flat_table{ encode_table };
+    static constexpr auto decode_table = static_huffman_detail::build_decode_table<code_length_limit>(encode_table);
+};
+
+#endif
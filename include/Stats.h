@@ -0,0 +1,212 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/*
+ * Instrumentation is compiled in with -DHUFFMAN_STATS=1 (the HUFFMAN_STATS
+ * CMake option). Without it the recorder is an empty class whose methods do
+ * nothing, so no clock is read and no counter is touched.
+ */
+#ifndef HUFFMAN_STATS
+#define HUFFMAN_STATS 0
+#endif
+
+inline constexpr bool stats_enabled = HUFFMAN_STATS != 0;
+
+enum class Stage { histogram, tree, table, encode, decode };
+inline constexpr std::size_t stage_count = 5;
+
+/* a snapshot of the counters; all zero when instrumentation is compiled out */
+struct HuffmanStats {
+    /* nanoseconds per stage; `tree` includes the priority queue and length limiting */
+    std::uint64_t histogram_ns = 0;
+    std::uint64_t tree_ns = 0;
+    std::uint64_t table_ns = 0;
+    std::uint64_t encode_ns = 0;
+    std::uint64_t decode_ns = 0;
+
+    /* raw bytes given to encode() and the encoded bytes it produced */
+    std::uint64_t bytes_in = 0;
+    std::uint64_t bytes_out = 0;
+    std::uint64_t bytes_decoded = 0;
+
+    /* code tables built, and decodes whose header did not match the trained table */
+    std::uint64_t tables_built = 0;
+    std::uint64_t decode_table_misses = 0;
+
+    /* bits per symbol of the trained code against the order-0 entropy of the training text */
+    double average_code_length = 0;
+    double entropy = 0;
+
+    std::string to_json() const {
+        char buffer[640];
+        std::snprintf(buffer,
+                      sizeof(buffer),
+                      "{\"histogram_ns\":%llu,\"tree_ns\":%llu,\"table_ns\":%llu,\"encode_ns\":%llu,"
+                      "\"decode_ns\":%llu,\"bytes_in\":%llu,\"bytes_out\":%llu,\"bytes_decoded\":%llu,"
+                      "\"tables_built\":%llu,\"decode_table_misses\":%llu,"
+                      "\"average_code_length\":%.6f,\"entropy\":%.6f}",
+                      static_cast<unsigned long long>(histogram_ns),
+                      static_cast<unsigned long long>(tree_ns),
+                      static_cast<unsigned long long>(table_ns),
+                      static_cast<unsigned long long>(encode_ns),
+                      static_cast<unsigned long long>(decode_ns),
+                      static_cast<unsigned long long>(bytes_in),
+                      static_cast<unsigned long long>(bytes_out),
+                      static_cast<unsigned long long>(bytes_decoded),
+                      static_cast<unsigned long long>(tables_built),
+                      static_cast<unsigned long long>(decode_table_misses),
+                      average_code_length,
+                      entropy);
+        return buffer;
+    }
+};
+
+/*
+ * Counters behind HuffmanStats. They are relaxed atomics so that concurrent
+ * encode/decode calls on one instance can record without a lock.
+ */
+template <bool Enabled>
+class BasicStatsRecorder {
+public:
+    BasicStatsRecorder() = default;
+    BasicStatsRecorder(const BasicStatsRecorder& other) {
+        copy_from(other);
+    }
+    BasicStatsRecorder& operator=(const BasicStatsRecorder& other) {
+        copy_from(other);
+        return *this;
+    }
+
+    /* measures the enclosing scope as `stage` */
+    class Timer {
+    public:
+        Timer(BasicStatsRecorder& recorder, Stage stage)
+            : recorder(recorder)
+            , stage(stage)
+            , start(std::chrono::steady_clock::now()) {
+        }
+        ~Timer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            recorder.add_time(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+    private:
+        BasicStatsRecorder& recorder;
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void add_time(Stage stage, std::int64_t ns) {
+        stage_ns[static_cast<std::size_t>(stage)].fetch_add(static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+    }
+    void add_encoded(std::size_t in, std::size_t out) {
+        bytes_in.fetch_add(in, std::memory_order_relaxed);
+        bytes_out.fetch_add(out, std::memory_order_relaxed);
+    }
+    void add_decoded(std::size_t out) {
+        bytes_decoded.fetch_add(out, std::memory_order_relaxed);
+    }
+    void add_table() {
+        tables_built.fetch_add(1, std::memory_order_relaxed);
+    }
+    void add_table_miss() {
+        decode_table_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    void set_code_quality(double average_code_length, double entropy) {
+        this->average_code_length = average_code_length;
+        this->entropy = entropy;
+    }
+
+    HuffmanStats snapshot() const {
+        HuffmanStats stats;
+        stats.histogram_ns = stage_ns[static_cast<std::size_t>(Stage::histogram)].load(std::memory_order_relaxed);
+        stats.tree_ns = stage_ns[static_cast<std::size_t>(Stage::tree)].load(std::memory_order_relaxed);
+        stats.table_ns = stage_ns[static_cast<std::size_t>(Stage::table)].load(std::memory_order_relaxed);
+        stats.encode_ns = stage_ns[static_cast<std::size_t>(Stage::encode)].load(std::memory_order_relaxed);
+        stats.decode_ns = stage_ns[static_cast<std::size_t>(Stage::decode)].load(std::memory_order_relaxed);
+        stats.bytes_in = bytes_in.load(std::memory_order_relaxed);
+        stats.bytes_out = bytes_out.load(std::memory_order_relaxed);
+        stats.bytes_decoded = bytes_decoded.load(std::memory_order_relaxed);
+        stats.tables_built = tables_built.load(std::memory_order_relaxed);
+        stats.decode_table_misses = decode_table_misses.load(std::memory_order_relaxed);
+        stats.average_code_length = average_code_length;
+        stats.entropy = entropy;
+        return stats;
+    }
+
+    /* clears the runtime counters; the code quality figures describe the table and stay */
+    void reset() {
+        for (auto& ns : stage_ns) {
+            ns.store(0, std::memory_order_relaxed);
+        }
+        bytes_in.store(0, std::memory_order_relaxed);
+        bytes_out.store(0, std::memory_order_relaxed);
+        bytes_decoded.store(0, std::memory_order_relaxed);
+        tables_built.store(0, std::memory_order_relaxed);
+        decode_table_misses.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> stage_ns[stage_count]{};
+    std::atomic<std::uint64_t> bytes_in{ 0 };
+    std::atomic<std::uint64_t> bytes_out{ 0 };
+    std::atomic<std::uint64_t> bytes_decoded{ 0 };
+    std::atomic<std::uint64_t> tables_built{ 0 };
+    std::atomic<std::uint64_t> decode_table_misses{ 0 };
+    double average_code_length = 0;
+    double entropy = 0;
+
+    void copy_from(const BasicStatsRecorder& other) {
+        for (std::size_t i = 0; i < stage_count; ++i) {
+            stage_ns[i].store(other.stage_ns[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        bytes_in.store(other.bytes_in.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bytes_out.store(other.bytes_out.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bytes_decoded.store(other.bytes_decoded.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        tables_built.store(other.tables_built.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        decode_table_misses.store(other.decode_table_misses.load(std::memory_order_relaxed),
+                                  std::memory_order_relaxed);
+        average_code_length = other.average_code_length;
+        entropy = other.entropy;
+    }
+};
+
+/* the compiled-out recorder: every call is a no-op the optimizer removes */
+template <>
+class BasicStatsRecorder<false> {
+public:
+    class Timer {
+    public:
+        Timer(BasicStatsRecorder&, Stage) {
+        }
+    };
+
+    void add_time(Stage, std::int64_t) {
+    }
+    void add_encoded(std::size_t, std::size_t) {
+    }
+    void add_decoded(std::size_t) {
+    }
+    void add_table() {
+    }
+    void add_table_miss() {
+    }
+    void set_code_quality(double, double) {
+    }
+    HuffmanStats snapshot() const {
+        return {};
+    }
+    void reset() {
+    }
+};
+
+using StatsRecorder = BasicStatsRecorder<stats_enabled>;
+
+#endif
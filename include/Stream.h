@@ -0,0 +1,412 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "./Block.h"
+#include "./ByteOrder.h"
+#include "./Checksum.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct StreamOptions {
+    std::size_t block_size = std::size_t{ 1 } << 16;
+    unsigned code_length_limit = max_code_length;
+    /* interleaved bitstreams per block, decoded in lockstep */
+    unsigned streams = 4;
+    /*
+     * a block keeps the previous block's table (a repeat block, see Block.h)
+     * while that is estimated to cost at most this fraction of the block more
+     * than a table of its own; 0 keeps it only when it is no worse
+     */
+    double max_reuse_loss = 0.01;
+};
+
+/*
+ * Stream layout: a sequence of frames, each a u32 uncompressed size, a u32
+ * encoded size and the u32 CRC-32C of the encoded bytes (little-endian)
+ * followed by one block. A frame with both sizes zero ends the stream.
+ * A repeat block decodes with the table of an earlier frame, so frames are
+ * only decodable in order.
+ */
+inline constexpr std::size_t frame_header_size = 12;
+
+/*
+ * Push input with write(), pull frames with read(), call finish() once the
+ * input is over and keep reading until done(). Each block is counted and then
+ * encoded (two passes over at most `block_size` bytes), with the previous
+ * block's table when its statistics are close enough; write() takes no
+ * more input while a finished frame is waiting to be read, so memory stays
+ * under memory_ceiling() whatever the input size.
+ */
+class StreamEncoder {
+    /* Outer handles */
+public:
+    explicit StreamEncoder(StreamOptions options = {})
+        : options(options) {
+        this->options.block_size = std::clamp<std::size_t>(this->options.block_size, 1, UINT32_MAX / 2);
+        history.max_reuse_loss = options.max_reuse_loss;
+        input.reserve(this->options.block_size);
+        output.reserve(frame_header_size + max_encoded_block_size(this->options.block_size));
+    }
+
+    /* returns how many bytes of `data` were taken */
+    std::size_t write(const char* data, std::size_t size) {
+        std::size_t taken = 0;
+        while (taken < size && !finishing) {
+            if (input.size() == options.block_size) {
+                advance();
+                if (input.size() == options.block_size) {
+                    break;
+                }
+            }
+
+            std::size_t chunk = std::min(size - taken, options.block_size - input.size());
+            input.append(data + taken, chunk);
+            taken += chunk;
+        }
+        advance();
+        return taken;
+    }
+
+    /* returns how many compressed bytes were copied into `out` */
+    std::size_t read(char* out, std::size_t capacity) {
+        std::size_t copied = 0;
+        while (copied < capacity) {
+            advance();
+            if (output_pos == output.size()) {
+                break;
+            }
+
+            std::size_t chunk = std::min(capacity - copied, output.size() - output_pos);
+            std::memcpy(out + copied, output.data() + output_pos, chunk);
+            output_pos += chunk;
+            copied += chunk;
+        }
+        return copied;
+    }
+
+    /* no more input; the last partial block and the end frame follow through read() */
+    void finish() {
+        finishing = true;
+        advance();
+    }
+
+    bool done() const {
+        return ended && output_pos == output.size();
+    }
+
+    std::size_t buffered() const {
+        return input.size() + output.size() - output_pos;
+    }
+    std::size_t memory_ceiling() const {
+        return options.block_size + frame_header_size + max_encoded_block_size(options.block_size);
+    }
+
+    /* Inner machinery */
+private:
+    StreamOptions options;
+    BlockEncodeHistory history;
+    std::string input;
+    std::string output;
+    std::size_t output_pos = 0;
+    bool finishing = false;
+    bool ended = false;
+
+    /* produces the next frame once the previous one has been read */
+    void advance() {
+        if (output_pos < output.size()) {
+            return;
+        }
+        output.clear();
+        output_pos = 0;
+
+        if (input.size() == options.block_size || (finishing && !input.empty())) {
+            std::size_t frame_start = output.size();
+            append_le32(output, static_cast<std::uint32_t>(input.size()));
+            append_le32(output, 0);
+            append_le32(output, 0);
+            encode_block(input.data(), input.size(), output, history, options.code_length_limit, options.streams);
+
+            const char* block = output.data() + frame_start + frame_header_size;
+            std::size_t block_size = output.size() - frame_start - frame_header_size;
+            store_le32(output.data() + frame_start + 4, static_cast<std::uint32_t>(block_size));
+            store_le32(output.data() + frame_start + 8, crc32c(block, block_size));
+            input.clear();
+        } else if (finishing && !ended) {
+            append_le32(output, 0);
+            append_le32(output, 0);
+            append_le32(output, 0);
+            ended = true;
+        }
+    }
+};
+
+/*
+ * Push compressed bytes with write() and pull the decoded ones with read().
+ * write() never buffers past the end of the current frame and frames larger
+ * than `block_size` are rejected, so memory is bounded the same way as on the
+ * encoder side.
+ */
+class StreamDecoder {
+    /* Outer handles */
+public:
+    explicit StreamDecoder(StreamOptions options = {})
+        : options(options) {
+        frame.reserve(frame_header_size + max_encoded_block_size(options.block_size));
+        output.reserve(options.block_size);
+    }
+
+    /* returns how many bytes of `data` were taken */
+    std::size_t write(const char* data, std::size_t size) {
+        std::size_t taken = 0;
+        while (taken < size) {
+            advance();
+            if (ended || !check_header()) {
+                break;
+            }
+
+            /* a complete frame waits here until its predecessor's output has been read */
+            std::size_t wanted = frame_wanted();
+            if (frame.size() == wanted) {
+                break;
+            }
+
+            std::size_t chunk = std::min(size - taken, wanted - frame.size());
+            frame.append(data + taken, chunk);
+            taken += chunk;
+        }
+        advance();
+        return taken;
+    }
+
+    /* returns how many decoded bytes were copied into `out` */
+    std::size_t read(char* out, std::size_t capacity) {
+        std::size_t copied = 0;
+        while (copied < capacity) {
+            advance();
+            if (output_pos == output.size()) {
+                break;
+            }
+
+            std::size_t chunk = std::min(capacity - copied, output.size() - output_pos);
+            std::memcpy(out + copied, output.data() + output_pos, chunk);
+            output_pos += chunk;
+            copied += chunk;
+        }
+        return copied;
+    }
+
+    /* no more input; a stream cut before its end frame becomes failed() once the output is read */
+    void finish() {
+        input_over = true;
+        advance();
+    }
+
+    bool done() const {
+        return ended && output_pos == output.size();
+    }
+    bool failed() const {
+        return corrupted;
+    }
+
+    std::size_t buffered() const {
+        return frame.size() + output.size() - output_pos;
+    }
+    std::size_t memory_ceiling() const {
+        return frame_header_size + max_encoded_block_size(options.block_size) + options.block_size;
+    }
+
+    /* Inner machinery */
+private:
+    StreamOptions options;
+    BlockDecodeHistory history;
+    std::string frame;
+    std::string output;
+    std::size_t output_pos = 0;
+    bool input_over = false;
+    bool ended = false;
+    bool corrupted = false;
+
+    /* rejects frames larger than the configured block size before buffering them */
+    bool check_header() {
+        if (!corrupted && frame.size() >= frame_header_size) {
+            std::uint32_t raw_size = load_le32(frame.data());
+            std::uint32_t encoded_size = load_le32(frame.data() + 4);
+            if (raw_size > options.block_size || encoded_size > max_encoded_block_size(raw_size) ||
+                (raw_size == 0) != (encoded_size == 0)) {
+                corrupted = true;
+            }
+        }
+        return !corrupted;
+    }
+
+    /* bytes of the current frame needed before it can be decoded */
+    std::size_t frame_wanted() const {
+        if (frame.size() < frame_header_size) {
+            return frame_header_size;
+        }
+        return frame_header_size + load_le32(frame.data() + 4);
+    }
+
+    void advance() {
+        if (output_pos < output.size() || ended || corrupted) {
+            return;
+        }
+        output.clear();
+        output_pos = 0;
+
+        if (frame.size() < frame_header_size || !check_header() || frame.size() < frame_wanted()) {
+            corrupted = corrupted || input_over;
+            return;
+        }
+
+        std::uint32_t raw_size = load_le32(frame.data());
+        std::uint32_t encoded_size = load_le32(frame.data() + 4);
+        if (raw_size == 0) {
+            ended = true;
+            return;
+        }
+
+        /* a damaged frame is caught here without running the decoder over it */
+        const char* block = frame.data() + frame_header_size;
+        if (crc32c(block, encoded_size) != load_le32(frame.data() + 8)) {
+            corrupted = true;
+            return;
+        }
+
+        output.resize(raw_size);
+        if (!decode_block(block, encoded_size, output.data(), raw_size, history)) {
+            output.clear();
+            corrupted = true;
+            return;
+        }
+        frame.clear();
+    }
+};
+
+/* drives a coder from `read_input` to `write_output` in fixed-size chunks */
+template <typename Coder, typename ReadInput, typename WriteOutput>
+bool pump_stream(Coder& coder, ReadInput read_input, WriteOutput write_output) {
+    std::vector<char> in_buf(std::size_t{ 1 } << 16);
+    std::vector<char> out_buf(std::size_t{ 1 } << 16);
+    std::size_t in_len = 0;
+    std::size_t in_pos = 0;
+    bool input_over = false;
+
+    while (true) {
+        if (in_pos == in_len && !input_over) {
+            long got = read_input(in_buf.data(), in_buf.size());
+            if (got < 0) {
+                return false;
+            }
+            in_len = static_cast<std::size_t>(got);
+            in_pos = 0;
+            if (in_len == 0) {
+                input_over = true;
+                coder.finish();
+            }
+        }
+
+        std::size_t taken = coder.write(in_buf.data() + in_pos, in_len - in_pos);
+        in_pos += taken;
+
+        std::size_t produced = coder.read(out_buf.data(), out_buf.size());
+        if (produced && !write_output(out_buf.data(), produced)) {
+            return false;
+        }
+
+        if (coder.done()) {
+            return true;
+        }
+        if constexpr (requires { coder.failed(); }) {
+            if (coder.failed()) {
+                return false;
+            }
+        }
+        if (input_over && produced == 0 && taken == 0) {
+            return false;
+        }
+    }
+}
+
+namespace stream_io {
+
+inline long read_istream(std::istream& in, char* data, std::size_t size) {
+    in.read(data, static_cast<std::streamsize>(size));
+    if (in.bad()) {
+        return -1;
+    }
+    return static_cast<long>(in.gcount());
+}
+
+inline bool write_ostream(std::ostream& out, const char* data, std::size_t size) {
+    out.write(data, static_cast<std::streamsize>(size));
+    return static_cast<bool>(out);
+}
+
+inline long read_fd(int fd, char* data, std::size_t size) {
+    while (true) {
+        ssize_t got = ::read(fd, data, size);
+        if (got >= 0 || errno != EINTR) {
+            return static_cast<long>(got);
+        }
+    }
+}
+
+inline bool write_fd(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t put = ::write(fd, data, size);
+        if (put < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += put;
+        size -= static_cast<std::size_t>(put);
+    }
+    return true;
+}
+
+}   // namespace stream_io
+
+inline bool encode_stream(std::istream& in, std::ostream& out, StreamOptions options = {}) {
+    StreamEncoder encoder(options);
+    return pump_stream(
+        encoder,
+        [&](char* data, std::size_t size) { return stream_io::read_istream(in, data, size); },
+        [&](const char* data, std::size_t size) { return stream_io::write_ostream(out, data, size); });
+}
+
+inline bool decode_stream(std::istream& in, std::ostream& out, StreamOptions options = {}) {
+    StreamDecoder decoder(options);
+    return pump_stream(
+        decoder,
+        [&](char* data, std::size_t size) { return stream_io::read_istream(in, data, size); },
+        [&](const char* data, std::size_t size) { return stream_io::write_ostream(out, data, size); });
+}
+
+inline bool encode_fd(int in_fd, int out_fd, StreamOptions options = {}) {
+    StreamEncoder encoder(options);
+    return pump_stream(
+        encoder,
+        [&](char* data, std::size_t size) { return stream_io::read_fd(in_fd, data, size); },
+        [&](const char* data, std::size_t size) { return stream_io::write_fd(out_fd, data, size); });
+}
+
+inline bool decode_fd(int in_fd, int out_fd, StreamOptions options = {}) {
+    StreamDecoder decoder(options);
+    return pump_stream(
+        decoder,
+        [&](char* data, std::size_t size) { return stream_io::read_fd(in_fd, data, size); },
+        [&](const char* data, std::size_t size) { return stream_io::write_fd(out_fd, data, size); });
+}
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Work-stealing pool: every worker owns a deque, takes work from its back and,
+ * when it runs dry, steals from the front of the other workers' deques.
+ * A pool with zero threads runs everything inline on the caller.
+ * parallel_for() may be called from inside a task: the worker waiting for
+ * the nested loop runs queued tasks meanwhile instead of blocking.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency()) {
+        for (unsigned i = 0; i < threads; ++i) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    void submit(std::function<void()> task) {
+        if (workers.empty()) {
+            task();
+            return;
+        }
+
+        /* counted before it is published, so a worker popping it at once never takes `queued` below zero */
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            queued++;
+        }
+        WorkQueue& queue = *queues[next_queue++ % queues.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    /* runs task(i) for every i in [0, count) and returns once all of them finished */
+    template <typename F>
+    void parallel_for(std::size_t count, F&& task) {
+        if (workers.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        std::latch done(static_cast<std::ptrdiff_t>(count));
+        for (std::size_t i = 0; i < count; ++i) {
+            submit([&task, &done, i] {
+                task(i);
+                done.count_down();
+            });
+        }
+        if (current_pool != this) {
+            done.wait();
+            return;
+        }
+        /* a nested call on one of our workers: blocking it could leave no worker for the tasks above */
+        std::function<void()> other;
+        while (!done.try_wait()) {
+            if (take(current_worker, other)) {
+                other();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> next_queue{ 0 };
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::size_t queued = 0;
+    bool stopping = false;
+
+    /* the pool and index of the worker running on this thread, if any */
+    static inline thread_local ThreadPool* current_pool = nullptr;
+    static inline thread_local unsigned current_worker = 0;
+
+    bool try_pop(unsigned self, std::function<void()>& task) {
+        for (std::size_t offset = 0; offset < queues.size(); ++offset) {
+            WorkQueue& queue = *queues[(self + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+
+            if (offset == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /* try_pop() that also uncounts the task */
+    bool take(unsigned self, std::function<void()>& task) {
+        if (!try_pop(self, task)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        queued--;
+        return true;
+    }
+
+    void worker_loop(unsigned self) {
+        current_pool = this;
+        current_worker = self;
+        std::function<void()> task;
+        while (true) {
+            if (take(self, task)) {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) {
+                return;
+            }
+        }
+    }
+};
+
+#endif
@@ -1,2 +1,333 @@
-int main() {
+#include "BlockCodec.h"
+#include "FileIO.h"
+#include "FilePipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct CliOptions {
+    bool decompress = false;
+    bool verify = false;
+    bool quiet = false;
+    BlockOptions block;
+    std::string input = "-";
+    std::string output = "-";
+};
+
+void print_usage() {
+    std::fprintf(stderr,
+                 "usage: huff [-c | -d | -v] [-b block_size] [-t threads] [-s streams] [-n] [-q] [input [output]]\n"
+                 "  -c  compress (default)\n"
+                 "  -d  decompress\n"
+                 "  -v  check the archive's checksums without decompressing it\n"
+                 "  -b  block size in bytes, K and M suffixes allowed (default 1M, at most 64M)\n"
+                 "  -t  worker threads, 0 runs everything on one thread (default: one per core, at most 4 per core)\n"
+                 "  -s  interleaved bitstreams per block, 1 to 16 (default 4)\n"
+                 "  -n  do not store block checksums\n"
+                 "  -q  do not print ratio and throughput\n"
+                 "  input and output default to stdin and stdout, '-' selects them explicitly\n");
+}
+
+/* a decimal count with an optional K or M suffix; false if it is malformed or does not fit */
+bool parse_count(const char* text, std::size_t& count) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (end == text) {
+        return false;
+    }
+    unsigned shift = 0;
+    if (*end == 'K' || *end == 'k') {
+        shift = 10;
+        ++end;
+    } else if (*end == 'M' || *end == 'm') {
+        shift = 20;
+        ++end;
+    }
+    if (value > (SIZE_MAX >> shift)) {
+        return false;
+    }
+    count = static_cast<std::size_t>(value) << shift;
+    return *end == '\0';
+}
+
+bool parse_size(const char* text, std::size_t& size) {
+    return parse_count(text, size) && size > 0;
+}
+
+/* more workers than this only add scheduling overhead (and a pathological -t would never start) */
+std::size_t max_threads() {
+    return 4 * std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool parse_args(int argc, char** argv, CliOptions& options) {
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "-c") {
+            options.decompress = false;
+            options.verify = false;
+        } else if (arg == "-d") {
+            options.decompress = true;
+            options.verify = false;
+        } else if (arg == "-v") {
+            options.verify = true;
+        } else if (arg == "-n") {
+            options.block.checksum = Checksum::none;
+        } else if (arg == "-q") {
+            options.quiet = true;
+        } else if (arg == "-b" && i + 1 < argc) {
+            if (!parse_size(argv[++i], options.block.block_size) || options.block.block_size > max_container_block_size) {
+                return false;
+            }
+        } else if (arg == "-t" && i + 1 < argc) {
+            std::size_t threads;
+            if (!parse_count(argv[++i], threads) || threads > max_threads()) {
+                return false;
+            }
+            options.block.threads = static_cast<unsigned>(threads);
+        } else if (arg == "-s" && i + 1 < argc) {
+            std::size_t streams;
+            if (!parse_size(argv[++i], streams) || streams > max_block_streams) {
+                return false;
+            }
+            options.block.streams = static_cast<unsigned>(streams);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            return false;
+        } else if (positional == 0) {
+            options.input = arg;
+            ++positional;
+        } else if (positional == 1) {
+            options.output = arg;
+            ++positional;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* `block_size` is the archive's, taken from its index when decompressing */
+void print_report(std::size_t in_size,
+                  std::size_t out_size,
+                  bool decompress,
+                  double seconds,
+                  unsigned threads,
+                  std::size_t block_size,
+                  const char* io) {
+    std::size_t raw_size = decompress ? out_size : in_size;
+    std::size_t packed_size = decompress ? in_size : out_size;
+    double ratio = raw_size ? static_cast<double>(packed_size) / static_cast<double>(raw_size) : 0.0;
+    double throughput = seconds > 0 ? static_cast<double>(raw_size) / seconds / 1e6 : 0.0;
+    std::fprintf(stderr,
+                 "huff: %zu -> %zu bytes, ratio %.3f, %.1f MB/s (%u threads, %zu byte blocks, %s)\n",
+                 in_size,
+                 out_size,
+                 ratio,
+                 throughput,
+                 threads,
+                 block_size,
+                 io);
+}
+
+/* truncating the output would destroy the input before it is read */
+bool same_file(const struct stat& a, const struct stat& b) {
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
+/* true if `output` names the file described by `input`, so it must not be opened with O_TRUNC */
+bool output_clobbers_input(const struct stat& input, const std::string& output) {
+    struct stat info;
+    if (output == "-") {
+        return ::fstat(STDOUT_FILENO, &info) == 0 && same_file(input, info);
+    }
+    return ::stat(output.c_str(), &info) == 0 && same_file(input, info);
+}
+
+/*
+ * Compresses a regular file into a regular file through the overlapped
+ * read/compress/write pipeline; returns -1 if the files do not qualify, so
+ * the caller falls back to the in-memory path. Stdout is written from its
+ * current position, and left to the in-memory path when opened for append.
+ */
+int compress_file(const CliOptions& options) {
+    struct stat in_info;
+    if (::stat(options.input.c_str(), &in_info) != 0 || !S_ISREG(in_info.st_mode)) {
+        return -1;
+    }
+    if (output_clobbers_input(in_info, options.output)) {
+        std::fprintf(stderr, "huff: %s is both input and output\n", options.input.c_str());
+        return 1;
+    }
+
+    struct stat out_info;
+    std::uint64_t out_start = 0;
+    if (options.output == "-") {
+        int flags = ::fcntl(STDOUT_FILENO, F_GETFL);
+        off_t position = ::lseek(STDOUT_FILENO, 0, SEEK_CUR);
+        if (::fstat(STDOUT_FILENO, &out_info) != 0 || !S_ISREG(out_info.st_mode) || flags < 0 ||
+            (flags & O_APPEND) || position < 0) {
+            return -1;
+        }
+        out_start = static_cast<std::uint64_t>(position);
+    } else if (::stat(options.output.c_str(), &out_info) == 0 && !S_ISREG(out_info.st_mode)) {
+        return -1;
+    }
+
+    int in_fd = ::open(options.input.c_str(), O_RDONLY);
+    if (in_fd < 0) {
+        return -1;
+    }
+    int out_fd = STDOUT_FILENO;
+    if (options.output != "-") {
+        out_fd = ::open(options.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out_fd < 0) {
+            ::close(in_fd);
+            std::fprintf(stderr, "huff: cannot open %s\n", options.output.c_str());
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FilePipeline pipeline({ options.block });
+    bool ok = pipeline.compress(in_fd, out_fd, out_start);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ::close(in_fd);
+    if (out_fd != STDOUT_FILENO) {
+        ok = ::close(out_fd) == 0 && ok;
+    } else if (ok) {
+        /* pwrite leaves the offset alone; move it past the archive for whoever writes next */
+        ok = ::lseek(out_fd, static_cast<off_t>(out_start + pipeline.get_encoded_size()), SEEK_SET) >= 0;
+    }
+    if (!ok) {
+        std::fprintf(stderr, "huff: cannot compress %s into %s\n", options.input.c_str(), options.output.c_str());
+        return 1;
+    }
+
+    if (!options.quiet) {
+        print_report(pipeline.get_raw_size(),
+                     pipeline.get_encoded_size(),
+                     false,
+                     seconds,
+                     pipeline.get_options().block.threads,
+                     pipeline.get_options().block.block_size,
+                     pipeline.get_backend());
+    }
+    return 0;
+}
+
+}   // namespace
+
+int main(int argc, char** argv) {
+    CliOptions options;
+    if (!parse_args(argc, argv, options)) {
+        print_usage();
+        return 2;
+    }
+
+    if (!options.decompress && !options.verify && options.input != "-") {
+        int status = compress_file(options);
+        if (status >= 0) {
+            return status;
+        }
+    }
+
+    /* files are mapped, anything else (pipes, terminals) is read into memory */
+    std::unique_ptr<MappedFile> mapped;
+    std::string buffered;
+    std::string_view input;
+    if (options.input != "-") {
+        mapped = std::make_unique<MappedFile>(options.input);
+        if (!mapped->ok()) {
+            std::fprintf(stderr, "huff: cannot map %s\n", options.input.c_str());
+            return 1;
+        }
+        input = mapped->view();
+    } else {
+        if (!read_all(STDIN_FILENO, buffered)) {
+            std::fprintf(stderr, "huff: cannot read stdin\n");
+            return 1;
+        }
+        input = buffered;
+    }
+
+    if (options.verify) {
+        BlockCodec codec(options.block);
+        if (!codec.verify(input)) {
+            std::fprintf(stderr, "huff: %s is damaged or not an archive\n", options.input.c_str());
+            return 1;
+        }
+        if (!options.quiet) {
+            std::fprintf(stderr, "huff: %s is intact\n", options.input.c_str());
+        }
+        return 0;
+    }
+
+    int out_fd = STDOUT_FILENO;
+    if (options.output != "-") {
+        struct stat in_info;
+        bool in_known = options.input != "-" ? ::stat(options.input.c_str(), &in_info) == 0
+                                             : ::fstat(STDIN_FILENO, &in_info) == 0;
+        if (in_known && output_clobbers_input(in_info, options.output)) {
+            std::fprintf(stderr, "huff: %s is both input and output\n", options.input.c_str());
+            return 1;
+        }
+        out_fd = ::open(options.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out_fd < 0) {
+            std::fprintf(stderr, "huff: cannot open %s\n", options.output.c_str());
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BlockCodec codec(options.block);
+    std::string result = options.decompress ? codec.decode(input) : codec.encode(input);
+    std::size_t block_size = codec.get_options().block_size;
+    if (options.decompress) {
+        std::vector<BlockIndexEntry> index;
+        bool valid = BlockCodec::read_index(input, index) &&
+                     result.size() == (index.empty() ? 0 : index.back().raw_offset + index.back().raw_size);
+        if (!valid) {
+            std::fprintf(stderr, "huff: %s is not a valid archive\n", options.input.c_str());
+            return 1;
+        }
+        /* every block but the last is full, so the first one has the size the archive was written with */
+        block_size = index.empty() ? 0 : index.front().raw_size;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool written = false;
+    {
+        AlignedWriter writer(out_fd);
+        written = writer.ok() && writer.write(result) && writer.flush();
+    }
+    if (out_fd != STDOUT_FILENO) {
+        written = ::close(out_fd) == 0 && written;
+    }
+    if (!written) {
+        std::fprintf(stderr, "huff: cannot write %s\n", options.output.c_str());
+        return 1;
+    }
+
+    if (!options.quiet) {
+        print_report(input.size(),
+                     result.size(),
+                     options.decompress,
+                     seconds,
+                     codec.get_options().threads,
+                     block_size,
+                     "in memory");
+    }
+    return 0;
 }
@@ -0,0 +1,56 @@
+#ifndef TEST_TEXT_H
+#define TEST_TEXT_H
+
+#include <cstddef>
+#include <random>
+#include <string>
+
+/*
+ * Inputs shared by the unit tests. Every generator is seeded explicitly, so
+ * the same arguments always give the same text.
+ */
+
+/* `size` bytes drawn uniformly from the `alphabet` values starting at `first` */
+inline std::string random_text(std::size_t size, unsigned alphabet, unsigned seed, char first = '\0') {
+    std::mt19937 rng(seed);
+    std::string text;
+    text.reserve(size);
+    while (text.size() < size) {
+        text.push_back(static_cast<char>(first + rng() % alphabet));
+    }
+    return text;
+}
+
+/* numbered words separated by spaces and the odd newline, like a log file */
+inline std::string word_text(std::size_t size, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::string text;
+    text.reserve(size);
+    while (text.size() < size) {
+        text += "word " + std::to_string(rng() % 5000) + (rng() % 4 ? " " : "\n");
+    }
+    text.resize(size);
+    return text;
+}
+
+/*
+ * Bytes from `first` on, geometrically skewed: of the `alphabet` values,
+ * (peak + k) % alphabet comes up with probability p(1 - p)^k.
+ */
+inline std::string skewed_text(std::size_t size,
+                               unsigned seed,
+                               unsigned alphabet = 31,
+                               unsigned peak = 0,
+                               double p = 0.3,
+                               char first = 'a') {
+    std::mt19937 rng(seed);
+    std::geometric_distribution<unsigned> pick(p);
+    std::string text;
+    text.reserve(size);
+    while (text.size() < size) {
+        text.push_back(static_cast<char>(first + (peak + pick(rng)) % alphabet));
+    }
+    return text;
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "../../../include/Adaptive.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <string>
+
+// Test round trips for several sizes and rebuild intervals, including every byte value
+TEST(AdaptiveTest, RoundTrip) {
+    std::string all_bytes;
+    for (int byte = 0; byte < 256; ++byte) {
+        all_bytes.push_back(static_cast<char>(byte));
+    }
+
+    for (std::size_t interval : { 1, 7, 256, 4096 }) {
+        AdaptiveOptions options{ interval };
+        for (const std::string& text : { std::string(), std::string("a"), all_bytes + skewed_text(20000, 1) }) {
+            std::string encoded = adaptive_encode(text.data(), text.size(), options);
+            std::string decoded;
+            ASSERT_TRUE(adaptive_decode(encoded.data(), encoded.size(), decoded, options))
+                << "interval " << interval << ", size " << text.size();
+            EXPECT_EQ(decoded, text);
+        }
+    }
+}
+
+// Test that codes adapt: skewed input ends up well below 8 bits per byte
+TEST(AdaptiveTest, Compresses) {
+    std::string text = skewed_text(100000, 2);
+    std::string encoded = adaptive_encode(text.data(), text.size());
+    EXPECT_LT(encoded.size(), text.size() / 2);
+}
+
+// Test that a length limit applies to the rebuilt codes
+TEST(AdaptiveTest, CodeLengthLimit) {
+    std::string text = skewed_text(50000, 3);
+    AdaptiveOptions options{ 1024, 12 };
+    std::string encoded = adaptive_encode(text.data(), text.size(), options);
+    std::string decoded;
+    ASSERT_TRUE(adaptive_decode(encoded.data(), encoded.size(), decoded, options));
+    EXPECT_EQ(decoded, text);
+}
+
+// Test that both sides produce output before the input is over
+TEST(AdaptiveTest, NoLookAhead) {
+    std::string text = skewed_text(30000, 4);
+    AdaptiveEncoder encoder;
+    AdaptiveDecoder decoder;
+    std::string encoded;
+    std::string decoded;
+
+    for (std::size_t pos = 0; pos < text.size(); pos += 1000) {
+        std::size_t before = encoded.size();
+        encoder.write(text.data() + pos, 1000, encoded);
+        EXPECT_GT(encoded.size(), before);
+
+        ASSERT_TRUE(decoder.write(encoded.data() + before, encoded.size() - before, decoded));
+        EXPECT_GT(decoded.size(), pos);
+        EXPECT_EQ(decoded, text.substr(0, decoded.size()));
+    }
+
+    std::size_t before = encoded.size();
+    encoder.finish(encoded);
+    ASSERT_TRUE(decoder.write(encoded.data() + before, encoded.size() - before, decoded));
+    ASSERT_TRUE(decoder.finish(decoded));
+    EXPECT_EQ(decoded, text);
+}
+
+// Test that the decoder accepts its input one byte at a time
+TEST(AdaptiveTest, ByteAtATimeInput) {
+    std::string text = skewed_text(5000, 5);
+    AdaptiveOptions options{ 100 };
+    std::string encoded = adaptive_encode(text.data(), text.size(), options);
+
+    AdaptiveDecoder decoder(options);
+    std::string decoded;
+    for (char byte : encoded) {
+        ASSERT_TRUE(decoder.write(&byte, 1, decoded));
+    }
+    ASSERT_TRUE(decoder.finish(decoded));
+    EXPECT_EQ(decoded, text);
+}
+
+// Test that truncated streams and mismatched options are rejected
+TEST(AdaptiveTest, RejectsDamagedStreams) {
+    std::string text = skewed_text(5000, 6);
+    std::string encoded = adaptive_encode(text.data(), text.size());
+    std::string decoded;
+
+    EXPECT_FALSE(adaptive_decode(encoded.data(), 0, decoded));
+    std::string truncated = encoded.substr(0, encoded.size() / 2);
+    truncated.push_back(3);
+    decoded.clear();
+    EXPECT_FALSE(adaptive_decode(truncated.data(), truncated.size(), decoded) && decoded == text);
+
+    decoded.clear();
+    EXPECT_FALSE(adaptive_decode(encoded.data(), encoded.size(), decoded, AdaptiveOptions{ 1000 }) &&
+                 decoded == text);
+}
@@ -0,0 +1,75 @@
+#include "../../../include/BitStream.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+// Test that bits are packed MSB-first
+TEST(BitWriterTest, PacksMsbFirst) {
+    std::string out;
+    BitWriter writer(out);
+    writer.write(0b1, 1);
+    writer.write(0b01, 2);
+    writer.write(0b00001, 5);
+    EXPECT_EQ(writer.finish(), 8);
+
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(static_cast<unsigned char>(out[0]), 0b10100001);
+}
+
+// Test the trailing bit count of a partial last byte
+TEST(BitWriterTest, TrailingBitCount) {
+    std::string out;
+    BitWriter writer(out);
+    writer.write(0b101, 3);
+    EXPECT_EQ(writer.finish(), 3);
+
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(static_cast<unsigned char>(out[0]), 0b10100000);
+}
+
+// Test that nothing is emitted for an empty writer
+TEST(BitWriterTest, EmptyWriter) {
+    std::string out;
+    BitWriter writer(out);
+    EXPECT_EQ(writer.finish(), 0);
+    EXPECT_TRUE(out.empty());
+}
+
+// Test codes that straddle the 64-bit register boundary
+TEST(BitWriterTest, WordBoundaryRoundTrip) {
+    std::string out;
+    BitWriter writer(out);
+    std::vector<std::pair<std::uint64_t, unsigned>> codes;
+    std::uint64_t bit_count = 0;
+    for (unsigned i = 0; i < 500; ++i) {
+        unsigned length = 1 + (i * 7) % 32;
+        std::uint64_t code = (i * 2654435761u) & ((std::uint64_t{ 1 } << length) - 1);
+        codes.emplace_back(code, length);
+        writer.write(code, length);
+        bit_count += length;
+    }
+    std::uint8_t last_byte_bits = writer.finish();
+    EXPECT_EQ(out.size(), (bit_count + 7) / 8);
+    EXPECT_EQ((out.size() - 1) * 8 + last_byte_bits, bit_count);
+
+    BitReader reader(out.data(), out.size(), bit_count);
+    for (const auto& [code, length] : codes) {
+        ASSERT_FALSE(reader.exhausted());
+        EXPECT_EQ(reader.read(length), code);
+    }
+    EXPECT_TRUE(reader.exhausted());
+}
+
+// Test that peeking past the end yields zero bits
+TEST(BitReaderTest, PeekPastEndIsZero) {
+    std::string out;
+    BitWriter writer(out);
+    writer.write(0b11, 2);
+    writer.finish();
+
+    BitReader reader(out.data(), out.size(), 2);
+    EXPECT_EQ(reader.peek(8), 0b11000000);
+    reader.consume(2);
+    EXPECT_TRUE(reader.exhausted());
+    EXPECT_EQ(reader.bits_remaining(), 0);
+}
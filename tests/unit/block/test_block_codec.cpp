@@ -0,0 +1,176 @@
+#include "../../../include/BlockCodec.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+namespace {
+
+std::string mixed_text(std::size_t size) {
+    std::mt19937 rng(42);
+    std::string text;
+    text.reserve(size);
+    const std::string words[] = { "alpha ", "beta ", "gamma ", "delta\n", "\x01\x02\xff" };
+    while (text.size() < size) {
+        text += words[rng() % 5];
+    }
+    text.resize(size);
+    return text;
+}
+
+}   // namespace
+
+// Test that an empty input produces an empty container
+TEST(BlockCodecTest, EmptyInput) {
+    BlockCodec codec;
+    std::string encoded = codec.encode("");
+    EXPECT_EQ(codec.decode(encoded), "");
+}
+
+// Test round trips over several block sizes and thread counts
+TEST(BlockCodecTest, RoundTripAcrossBlockSizes) {
+    std::string text = mixed_text(100000);
+
+    for (std::size_t block_size : { 1000, 4096, 65536, 1 << 20 }) {
+        for (unsigned threads : { 0u, 1u, 4u }) {
+            BlockCodec codec({ block_size, threads });
+            std::string encoded = codec.encode(text);
+            EXPECT_LT(encoded.size(), text.size());
+            EXPECT_EQ(codec.decode(encoded), text) << block_size << " / " << threads;
+        }
+    }
+}
+
+// Test that the container is identical whatever the number of threads
+TEST(BlockCodecTest, OutputIndependentOfThreads) {
+    std::string text = mixed_text(50000);
+    BlockCodec serial({ 4096, 0 });
+    BlockCodec parallel({ 4096, 4 });
+    EXPECT_EQ(serial.encode(text), parallel.encode(text));
+}
+
+// Test that each block is decodable on its own
+TEST(BlockCodecTest, BlocksAreSelfContained) {
+    std::string text = "aaaaaaaaaabbbbbccc";
+    std::string block;
+    encode_block(text.data(), text.size(), block);
+
+    std::string decoded;
+    EXPECT_TRUE(decode_block(block.data(), block.size(), decoded));
+    EXPECT_EQ(decoded, text);
+}
+
+// Test that truncated containers are rejected
+TEST(BlockCodecTest, RejectsTruncatedContainer) {
+    std::string text = mixed_text(10000);
+    BlockCodec codec({ 1000, 2 });
+    std::string encoded = codec.encode(text);
+
+    encoded.resize(encoded.size() / 2);
+    EXPECT_EQ(codec.decode(encoded), "");
+}
+
+// Test that the footer index describes every block
+TEST(BlockCodecTest, IndexDescribesBlocks) {
+    std::string text = mixed_text(10500);
+    BlockCodec codec({ 1000, 2 });
+    std::string encoded = codec.encode(text);
+
+    std::vector<BlockIndexEntry> index;
+    ASSERT_TRUE(BlockCodec::read_index(encoded, index));
+    ASSERT_EQ(index.size(), 11);
+    for (std::size_t i = 0; i < index.size(); ++i) {
+        EXPECT_EQ(index[i].raw_offset, i * 1000);
+        EXPECT_EQ(index[i].raw_size, i + 1 < index.size() ? 1000 : 500);
+
+        std::string decoded;
+        EXPECT_TRUE(decode_block(encoded.data() + index[i].offset, index[i].size, decoded));
+        EXPECT_EQ(decoded, text.substr(i * 1000, 1000));
+    }
+}
+
+// Test random access into the middle of a container
+TEST(BlockCodecTest, DecodeRange) {
+    std::string text = mixed_text(20000);
+    BlockCodec codec({ 1024, 2 });
+    std::string encoded = codec.encode(text);
+
+    EXPECT_EQ(codec.decode_range(encoded, 0, 10), text.substr(0, 10));
+    EXPECT_EQ(codec.decode_range(encoded, 1020, 10), text.substr(1020, 10));
+    EXPECT_EQ(codec.decode_range(encoded, 5000, 7000), text.substr(5000, 7000));
+    EXPECT_EQ(codec.decode_range(encoded, 19990, 100), text.substr(19990));
+    EXPECT_EQ(codec.decode_range(encoded, 20000, 10), "");
+    EXPECT_EQ(codec.decode_range(encoded, 10, 0), "");
+}
+
+// Test that a corrupted block size in the index is rejected
+TEST(BlockCodecTest, RejectsInconsistentIndex) {
+    std::string text = mixed_text(5000);
+    BlockCodec codec({ 1000, 2 });
+    std::string encoded = codec.encode(text);
+
+    std::vector<BlockIndexEntry> index;
+    ASSERT_TRUE(BlockCodec::read_index(encoded, index));
+    std::size_t index_offset = encoded.size() - BlockCodec::footer_size - BlockCodec::index_entry_size * index.size();
+    encoded[index_offset + 8] ^= 0x01;   // raw size of the first block
+
+    EXPECT_EQ(codec.decode(encoded), "");
+}
+
+// Test that the structural checks still hold for a container without checksums
+TEST(BlockCodecTest, RejectsInconsistentIndexWithoutChecksums) {
+    std::string text = mixed_text(5000);
+    BlockCodec codec({ 1000, 2, max_code_length, 4, Checksum::none });
+    std::string encoded = codec.encode(text);
+    ASSERT_EQ(codec.decode(encoded), text);
+
+    std::vector<BlockIndexEntry> index;
+    ASSERT_TRUE(BlockCodec::read_index(encoded, index));
+    std::size_t index_offset = encoded.size() - BlockCodec::footer_size - BlockCodec::index_entry_size * index.size();
+    encoded[index_offset + 8] ^= 0x01;
+
+    EXPECT_EQ(codec.decode(encoded), "");
+}
+
+// Test that a run block claiming more than the container allows is rejected instead of allocated
+TEST(BlockCodecTest, RejectsOversizedRunCount) {
+    for (std::uint64_t count : { std::uint64_t{ max_container_block_size } + 1, std::uint64_t{ 1 } << 62 }) {
+        std::string block = { static_cast<char>(run_block_tag), 'x' };
+        append_varint(block, count);
+
+        std::string encoded = BlockCodec::container_header(Checksum::crc32c);
+        std::vector<BlockIndexEntry> index = {
+            { encoded.size(), block.size(), 0, count, block_checksum(Checksum::crc32c, block.data(), block.size()) }
+        };
+        encoded += block;
+        encoded += BlockCodec::container_trailer(index, encoded.size(), Checksum::crc32c);
+
+        BlockCodec codec;
+        std::vector<BlockIndexEntry> read;
+        EXPECT_FALSE(BlockCodec::read_index(encoded, read)) << count;
+        EXPECT_EQ(codec.decode(encoded), "");
+        EXPECT_EQ(codec.decode_range(encoded, 0, 10), "");
+        EXPECT_FALSE(codec.verify(encoded));
+    }
+}
+
+// Test that every block but the last must have the container's block size
+TEST(BlockCodecTest, RejectsUnevenBlocks) {
+    std::string encoded = BlockCodec::container_header(Checksum::crc32c);
+    std::vector<BlockIndexEntry> index;
+    for (std::uint64_t count : { 10, 1000 }) {
+        std::string block = { static_cast<char>(run_block_tag), 'x' };
+        append_varint(block, count);
+        index.push_back({ encoded.size(), block.size(), 0, count, block_checksum(Checksum::crc32c, block.data(), block.size()) });
+        encoded += block;
+    }
+    encoded += BlockCodec::container_trailer(index, encoded.size(), Checksum::crc32c);
+
+    BlockCodec codec;
+    EXPECT_EQ(codec.decode(encoded), "");
+}
+
+// Test that the encoder never writes blocks larger than a decoder accepts
+TEST(BlockCodecTest, ClampsBlockSize) {
+    BlockCodec codec({ max_container_block_size * 4, 1 });
+    EXPECT_EQ(codec.get_options().block_size, max_container_block_size);
+}
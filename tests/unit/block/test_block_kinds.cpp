@@ -0,0 +1,103 @@
+#include "../../../include/Block.h"
+#include "../../../include/BlockCodec.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+
+std::string round_trip(const std::string& block, std::size_t raw_size) {
+    std::string decoded(raw_size, '\0');
+    EXPECT_TRUE(decode_block(block.data(), block.size(), decoded.data(), raw_size));
+    std::string appended;
+    EXPECT_TRUE(decode_block(block.data(), block.size(), appended));
+    EXPECT_EQ(appended, decoded);
+    return decoded;
+}
+
+}   // namespace
+
+// Test that incompressible input is stored with one byte of overhead
+TEST(BlockKindTest, RandomBytesAreStored) {
+    std::string text = random_text(1 << 16, 256, 7);
+    std::string block;
+    encode_block(text.data(), text.size(), block, max_code_length, 4);
+
+    EXPECT_EQ(block_kind(block.data(), block.size()), BlockKind::stored);
+    EXPECT_EQ(block.size(), text.size() + 1);
+    EXPECT_EQ(round_trip(block, text.size()), text);
+}
+
+// Test that a single repeated byte becomes a run block of a few bytes
+TEST(BlockKindTest, SingleSymbolIsRun) {
+    std::string text(1000000, '\0');
+    std::string block;
+    encode_block(text.data(), text.size(), block);
+
+    EXPECT_EQ(block_kind(block.data(), block.size()), BlockKind::run);
+    EXPECT_LE(block.size(), 6);
+    EXPECT_EQ(max_decoded_block_size(block.data(), block.size()), text.size());
+    EXPECT_EQ(round_trip(block, text.size()), text);
+}
+
+// Test that compressible input is still Huffman coded
+TEST(BlockKindTest, SkewedInputIsCoded) {
+    std::string text;
+    for (int i = 0; i < 10000; ++i) {
+        text += i % 5 ? "aaab" : "cd";
+    }
+    std::string block;
+    encode_block(text.data(), text.size(), block);
+
+    EXPECT_EQ(block_kind(block.data(), block.size()), BlockKind::huffman);
+    EXPECT_LT(block.size(), text.size() / 2);
+    EXPECT_EQ(round_trip(block, text.size()), text);
+}
+
+// Test the entropy estimate against known distributions
+TEST(BlockKindTest, EntropyEstimate) {
+    FrequencyTable uniform{};
+    uniform.fill(4);
+    EXPECT_DOUBLE_EQ(entropy_bits(uniform, 1024), 8 * 1024);
+
+    FrequencyTable two{};
+    two['a'] = 50;
+    two['b'] = 50;
+    EXPECT_DOUBLE_EQ(entropy_bits(two, 100), 100);
+    EXPECT_LT(predicted_block_size(two, 100, 1), 101);
+    EXPECT_GE(predicted_block_size(uniform, 1024, 1), 1025);
+}
+
+// Test that stored and run blocks with the wrong size or a bad count are rejected
+TEST(BlockKindTest, RejectsInconsistentBlocks) {
+    std::string stored = { static_cast<char>(stored_block_tag), 'x', 'y' };
+    std::string out(3, '\0');
+    EXPECT_FALSE(decode_block(stored.data(), stored.size(), out.data(), 3));
+
+    std::string run = { static_cast<char>(run_block_tag), 'x' };
+    EXPECT_FALSE(decode_block(run.data(), run.size(), out.data(), 0));
+    run.push_back(static_cast<char>(0x83));
+    EXPECT_FALSE(decode_block(run.data(), run.size(), out));
+    run.back() = 3;
+    EXPECT_TRUE(decode_block(run.data(), run.size(), out.data(), 3));
+    EXPECT_EQ(out, "xxx");
+    EXPECT_FALSE(decode_block(run.data(), run.size(), out.data(), 2));
+}
+
+// Test that archives mixing all three kinds round-trip and index correctly
+TEST(BlockKindTest, MixedArchive) {
+    std::string text = random_text(5000, 256, 7) + std::string(5000, 'q') + std::string(5000, 'a');
+    for (int i = 0; i < 5000; ++i) {
+        text[10000 + i] = "abcabd"[i % 6];
+    }
+    BlockCodec codec({ 5000, 2 });
+    std::string encoded = codec.encode(text);
+
+    std::vector<BlockIndexEntry> index;
+    ASSERT_TRUE(BlockCodec::read_index(encoded, index));
+    ASSERT_EQ(index.size(), 3);
+    EXPECT_EQ(block_kind(encoded.data() + index[0].offset, index[0].size), BlockKind::stored);
+    EXPECT_EQ(block_kind(encoded.data() + index[1].offset, index[1].size), BlockKind::run);
+    EXPECT_EQ(block_kind(encoded.data() + index[2].offset, index[2].size), BlockKind::huffman);
+    EXPECT_EQ(codec.decode(encoded), text);
+}
@@ -0,0 +1,88 @@
+#include "../../../include/Block.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <string>
+
+// Test round trips for every stream count; inputs too short to pay for the streams come out stored
+TEST(MultiStreamTest, RoundTripEveryStreamCount) {
+    for (unsigned streams = 1; streams <= max_block_streams; ++streams) {
+        for (std::size_t size : { 1, 2, 3, 7, 15, 16, 17, 1000, 4099 }) {
+            std::string text = skewed_text(size, 99);
+            std::string block;
+            encode_block(text.data(), text.size(), block, max_code_length, streams);
+
+            if (size >= 1000) {
+                BlockView view;
+                ASSERT_TRUE(parse_block(block.data(), block.size(), view));
+                EXPECT_EQ(view.stream_count, streams);
+            } else {
+                EXPECT_LE(block.size(), size + 1);
+            }
+
+            std::string decoded(size, '\0');
+            EXPECT_TRUE(decode_block(block.data(), block.size(), decoded.data(), size))
+                << streams << " streams, " << size << " bytes";
+            EXPECT_EQ(decoded, text);
+
+            std::string appended;
+            EXPECT_TRUE(decode_block(block.data(), block.size(), appended));
+            EXPECT_EQ(appended, text);
+        }
+    }
+}
+
+// Test that segments split the input evenly with the remainder on the last stream
+TEST(MultiStreamTest, SegmentBoundaries) {
+    EXPECT_EQ(stream_segment_begin(10, 4, 0), 0);
+    EXPECT_EQ(stream_segment_begin(10, 4, 1), 3);
+    EXPECT_EQ(stream_segment_begin(10, 4, 3), 9);
+    EXPECT_EQ(stream_segment_begin(10, 4, 4), 10);
+    EXPECT_EQ(stream_segment_begin(2, 4, 3), 2);
+}
+
+// Test that the jump table costs only a few bytes over a single stream
+TEST(MultiStreamTest, JumpTableOverhead) {
+    std::string text = skewed_text(100000, 99);
+    std::string single;
+    std::string quad;
+    encode_block(text.data(), text.size(), single, max_code_length, 1);
+    encode_block(text.data(), text.size(), quad, max_code_length, 4);
+
+    EXPECT_LE(quad.size(), single.size() + 3 * 4 + 3 + 3);
+    EXPECT_LE(quad.size(), max_encoded_block_size(text.size()));
+}
+
+// Test that a wrong expected size or a damaged jump table is detected
+TEST(MultiStreamTest, RejectsInconsistentBlocks) {
+    std::string text = skewed_text(5000, 99);
+    std::string block;
+    encode_block(text.data(), text.size(), block, max_code_length, 4);
+
+    std::string decoded(text.size() + 1, '\0');
+    EXPECT_FALSE(decode_block(block.data(), block.size(), decoded.data(), text.size() + 1));
+
+    BlockView view;
+    ASSERT_TRUE(parse_block(block.data(), block.size(), view));
+    std::size_t jump_table = view.streams[0].packed - block.data() - 12;
+    block[jump_table] = static_cast<char>(block[jump_table] + 1);
+    EXPECT_FALSE(parse_block(block.data(), block.size(), view) &&
+                 decode_block(block.data(), block.size(), decoded.data(), text.size()));
+}
+
+// Test that a stream cut short by a damaged trailer fails the appending decoder too
+TEST(MultiStreamTest, AppendingDecoderRejectsDamagedTrailer) {
+    std::string text = skewed_text(5000, 99);
+    std::string block;
+    encode_block(text.data(), text.size(), block, max_code_length, 4);
+
+    std::string decoded;
+    ASSERT_TRUE(decode_block(block.data(), block.size(), decoded));
+    EXPECT_EQ(decoded, text);
+
+    BlockView view;
+    ASSERT_TRUE(parse_block(block.data(), block.size(), view));
+    std::size_t trailer = view.streams[0].packed - block.data() + view.streams[0].packed_size;
+    block[trailer] = static_cast<char>(block[trailer] == 1 ? 8 : block[trailer] - 1);
+    decoded.clear();
+    EXPECT_FALSE(decode_block(block.data(), block.size(), decoded));
+}
@@ -0,0 +1,90 @@
+#include "../../../include/Block.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+/* encodes `blocks` as one sequence, then decodes them in order with a fresh history */
+std::vector<std::string> encode_sequence(const std::vector<std::string>& blocks, double max_reuse_loss) {
+    BlockEncodeHistory history;
+    history.max_reuse_loss = max_reuse_loss;
+    std::vector<std::string> encoded;
+    for (const std::string& block : blocks) {
+        encoded.emplace_back();
+        encode_block(block.data(), block.size(), encoded.back(), history, max_code_length, 4);
+    }
+
+    BlockDecodeHistory decode_history;
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        std::string decoded(blocks[i].size(), '\0');
+        EXPECT_TRUE(decode_block(
+            encoded[i].data(), encoded[i].size(), decoded.data(), decoded.size(), decode_history))
+            << i;
+        EXPECT_EQ(decoded, blocks[i]) << i;
+    }
+    return encoded;
+}
+
+BlockKind kind(const std::string& block) {
+    return block_kind(block.data(), block.size());
+}
+
+}   // namespace
+
+// Test that blocks drawn from one distribution keep the first block's table
+TEST(TableReuseTest, SimilarBlocksRepeatTable) {
+    std::vector<std::string> blocks;
+    for (unsigned seed = 1; seed <= 4; ++seed) {
+        blocks.push_back(skewed_text(8192, seed, 20));
+    }
+    std::vector<std::string> encoded = encode_sequence(blocks, 0.01);
+
+    EXPECT_EQ(kind(encoded[0]), BlockKind::huffman);
+    for (std::size_t i = 1; i < encoded.size(); ++i) {
+        EXPECT_EQ(kind(encoded[i]), BlockKind::repeat) << i;
+        EXPECT_LT(encoded[i].size(), encoded[0].size());
+    }
+}
+
+// Test that a block with a byte the previous code lacks builds its own table
+TEST(TableReuseTest, UncoveredSymbolRebuilds) {
+    std::vector<std::string> blocks = { skewed_text(8192, 1, 10), skewed_text(8192, 2, 10) + "z" };
+    std::vector<std::string> encoded = encode_sequence(blocks, 1.0);
+
+    EXPECT_EQ(kind(encoded[1]), BlockKind::huffman);
+}
+
+// Test that the loss threshold decides between reuse and a new table
+TEST(TableReuseTest, ThresholdBoundsLoss) {
+    std::vector<std::string> blocks = { skewed_text(8192, 1, 12), skewed_text(8192, 2, 12, 6) };
+
+    EXPECT_EQ(kind(encode_sequence(blocks, 0)[1]), BlockKind::huffman);
+    EXPECT_EQ(kind(encode_sequence(blocks, 1.0)[1]), BlockKind::repeat);
+}
+
+// Test that stored and run blocks in between leave the table in place on both sides
+TEST(TableReuseTest, TableSurvivesOtherKinds) {
+    std::string noise = random_text(4096, 256, 3);
+    std::vector<std::string> blocks = {
+        skewed_text(8192, 1, 20), std::string(5000, 'q'), noise, skewed_text(8192, 2, 20)
+    };
+    std::vector<std::string> encoded = encode_sequence(blocks, 0.01);
+
+    EXPECT_EQ(kind(encoded[1]), BlockKind::run);
+    EXPECT_EQ(kind(encoded[2]), BlockKind::stored);
+    EXPECT_EQ(kind(encoded[3]), BlockKind::repeat);
+}
+
+// Test that a repeat block is rejected without a table to repeat
+TEST(TableReuseTest, RepeatWithoutHistoryFails) {
+    std::vector<std::string> blocks = { skewed_text(8192, 1, 20), skewed_text(8192, 2, 20) };
+    std::vector<std::string> encoded = encode_sequence(blocks, 0.01);
+    ASSERT_EQ(kind(encoded[1]), BlockKind::repeat);
+
+    std::string decoded(blocks[1].size(), '\0');
+    BlockDecodeHistory history;
+    EXPECT_FALSE(decode_block(encoded[1].data(), encoded[1].size(), decoded.data(), decoded.size(), history));
+    EXPECT_FALSE(decode_block(encoded[1].data(), encoded[1].size(), decoded.data(), decoded.size()));
+}
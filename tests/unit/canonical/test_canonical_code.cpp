@@ -0,0 +1,94 @@
+#include "../../../include/CanonicalCode.h"
+#include "../../../include/Huffman.h"
+#include <gtest/gtest.h>
+#include <string>
+
+// Test canonical assignment against the RFC 1951 example (ABCDEFGH with lengths 3,3,3,3,3,2,4,4)
+TEST(CanonicalCodeTest, AssignsCodesInLengthThenSymbolOrder) {
+    CodeLengths lengths{};
+    const std::uint8_t example[] = { 3, 3, 3, 3, 3, 2, 4, 4 };
+    for (int i = 0; i < 8; ++i) {
+        lengths['A' + i] = example[i];
+    }
+
+    std::vector<PrefixCode> codes = assign_canonical_codes(lengths);
+    ASSERT_EQ(codes.size(), 8);
+
+    std::map<std::uint32_t, std::uint64_t> by_symbol;
+    for (const PrefixCode& code : codes) {
+        by_symbol[code.symbol] = code.code;
+    }
+    EXPECT_EQ(by_symbol['F'], 0b00);
+    EXPECT_EQ(by_symbol['A'], 0b010);
+    EXPECT_EQ(by_symbol['B'], 0b011);
+    EXPECT_EQ(by_symbol['C'], 0b100);
+    EXPECT_EQ(by_symbol['D'], 0b101);
+    EXPECT_EQ(by_symbol['E'], 0b110);
+    EXPECT_EQ(by_symbol['G'], 0b1110);
+    EXPECT_EQ(by_symbol['H'], 0b1111);
+}
+
+// Test that the header round-trips and stays small for sparse alphabets
+TEST(CanonicalCodeTest, HeaderRoundTrip) {
+    CodeLengths lengths{};
+    lengths['a'] = 1;
+    lengths['b'] = 2;
+    lengths['c'] = 2;
+
+    std::string header;
+    write_code_lengths(lengths, header);
+    EXPECT_LE(header.size(), 8);
+
+    CodeLengths parsed{};
+    EXPECT_EQ(read_code_lengths(header.data(), header.size(), parsed), header.size());
+    EXPECT_EQ(parsed, lengths);
+}
+
+// Test that a full byte alphabet with equal lengths collapses into a few header bytes
+TEST(CanonicalCodeTest, UniformHeaderIsCompact) {
+    CodeLengths lengths;
+    lengths.fill(8);
+
+    std::string header;
+    write_code_lengths(lengths, header);
+    EXPECT_LE(header.size(), 5);
+
+    CodeLengths parsed{};
+    EXPECT_EQ(read_code_lengths(header.data(), header.size(), parsed), header.size());
+    EXPECT_EQ(parsed, lengths);
+}
+
+// Test that truncated and oversubscribed headers are rejected
+TEST(CanonicalCodeTest, RejectsMalformedHeaders) {
+    CodeLengths lengths{};
+    lengths['a'] = 1;
+    lengths['b'] = 1;
+    lengths['c'] = 1;
+
+    std::string header;
+    write_code_lengths(lengths, header);
+
+    CodeLengths parsed{};
+    EXPECT_EQ(read_code_lengths(header.data(), header.size(), parsed), 0);
+    EXPECT_EQ(read_code_lengths(header.data(), 1, parsed), 0);
+}
+
+// Test that codes no longer depend on which tree shape produced the lengths
+TEST(CanonicalCodeTest, HuffmanCodesAreCanonical) {
+    Huffman huffman("aaabbc");
+    auto encoding_table = huffman.get_encoding_table();
+
+    EXPECT_EQ(encoding_table["a"], "0");
+    EXPECT_EQ(encoding_table["b"], "10");
+    EXPECT_EQ(encoding_table["c"], "11");
+}
+
+// Test that a stream carries its own table and decodes in a different instance
+TEST(CanonicalCodeTest, DecodesWithoutTheEncodingInstance) {
+    std::string text = "the header travels with the stream";
+    Huffman encoder(text);
+    std::string encoded = encoder.encode(text);
+
+    Huffman decoder("completely unrelated training text");
+    EXPECT_EQ(decoder.decode(encoded), text);
+}
@@ -0,0 +1,71 @@
+#include "../../../include/BlockCodec.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <string>
+
+// Test the standard CRC-32C check value
+TEST(ChecksumTest, KnownValue) {
+    std::string check = "123456789";
+    EXPECT_EQ(crc32c_scalar(check.data(), check.size()), 0xE3069283u);
+    EXPECT_EQ(crc32c(check.data(), check.size()), 0xE3069283u);
+    EXPECT_EQ(crc32c("", 0), 0u);
+}
+
+// Test that the hardware and table versions agree and can be continued
+TEST(ChecksumTest, HardwareMatchesTable) {
+    std::string text = word_text(10007, 19);
+
+    for (std::size_t size : { 0, 1, 7, 8, 9, 63, 1000, 10007 }) {
+        EXPECT_EQ(crc32c(text.data(), size), crc32c_scalar(text.data(), size)) << size;
+    }
+
+    std::uint32_t whole = crc32c(text.data(), text.size());
+    std::uint32_t split = crc32c(text.data() + 333, text.size() - 333, crc32c(text.data(), 333));
+    EXPECT_EQ(whole, split);
+}
+
+// Test that verify() and decode() catch a flipped bit anywhere in the container
+TEST(ChecksumTest, DetectsCorruption) {
+    std::string text = word_text(20000, 19);
+    BlockCodec codec({ 4096, 2 });
+    std::string encoded = codec.encode(text);
+    ASSERT_TRUE(codec.verify(encoded));
+
+    for (std::size_t pos = 0; pos < encoded.size(); pos += 97) {
+        std::string damaged = encoded;
+        damaged[pos] ^= 0x04;
+        EXPECT_FALSE(codec.verify(damaged)) << pos;
+        EXPECT_EQ(codec.decode(damaged), "") << pos;
+    }
+}
+
+// Test that a foreign magic or an unknown version is refused
+TEST(ChecksumTest, RejectsUnknownHeader) {
+    BlockCodec codec({ 1024, 0 });
+    std::string encoded = codec.encode(word_text(3000, 19));
+
+    std::string foreign = encoded;
+    foreign[0] = 'X';
+    EXPECT_FALSE(codec.verify(foreign));
+
+    std::string newer = encoded;
+    newer[4] = static_cast<char>(BlockCodec::version + 1);
+    EXPECT_FALSE(codec.verify(newer));
+}
+
+// Test that checksums can be left out and the container still decodes
+TEST(ChecksumTest, ChecksumsAreOptional) {
+    std::string text = word_text(20000, 19);
+    BlockCodec plain({ 4096, 2, max_code_length, 4, Checksum::none });
+    std::string encoded = plain.encode(text);
+
+    std::vector<BlockIndexEntry> index;
+    ASSERT_TRUE(BlockCodec::read_index(encoded, index));
+    for (const BlockIndexEntry& entry : index) {
+        EXPECT_EQ(entry.checksum, 0u);
+    }
+
+    BlockCodec checked;
+    EXPECT_TRUE(checked.verify(encoded));
+    EXPECT_EQ(checked.decode(encoded), text);
+}
@@ -0,0 +1,115 @@
+#include "../../../include/CodeTable.h"
+#include "../../../include/Huffman.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+// Test that one trained table encodes and decodes many messages without retraining
+TEST(CodeTableTest, EncodesManyMessages) {
+    std::string sample = "GET /api/v1/users?id=42 HTTP/1.1\r\nHost: example.com\r\n";
+    CodeTable table = CodeTable::train(sample.data(), sample.size());
+
+    std::vector<std::string> messages = { "GET /api/v1/users?id=24", "Host: example.com", "", "HTTP/1.1\r\n" };
+    for (const std::string& message : messages) {
+        std::string encoded;
+        ASSERT_TRUE(table.encode(message.data(), message.size(), encoded)) << message;
+        EXPECT_LE(encoded.size(), message.size() + 1);
+
+        std::string decoded;
+        ASSERT_TRUE(table.decode(encoded.data(), encoded.size(), decoded));
+        EXPECT_EQ(decoded, message);
+    }
+}
+
+// Test that a serialized table loads into an equal, interchangeable table
+TEST(CodeTableTest, SerializeRoundTrip) {
+    std::string sample = "abracadabra alakazam";
+    CodeTable table = CodeTable::train(sample.data(), sample.size());
+    std::string bytes = table.serialize() + "trailing";
+
+    CodeTable loaded;
+    std::size_t consumed = CodeTable::deserialize(bytes.data(), bytes.size(), loaded);
+    ASSERT_EQ(consumed, bytes.size() - 8);
+    EXPECT_EQ(loaded, table);
+
+    std::string message = "abracadabra";
+    std::string encoded;
+    ASSERT_TRUE(table.encode(message.data(), message.size(), encoded));
+    std::string decoded;
+    ASSERT_TRUE(loaded.decode(encoded.data(), encoded.size(), decoded));
+    EXPECT_EQ(decoded, message);
+}
+
+// Test that malformed serialized tables are rejected
+TEST(CodeTableTest, DeserializeRejectsGarbage) {
+    CodeTable table;
+    std::string truncated = CodeTable::train("hello", 5).serialize();
+    truncated.pop_back();
+    EXPECT_EQ(CodeTable::deserialize(truncated.data(), truncated.size(), table), 0);
+
+    /* 256 one-bit codes oversubscribe the code space */
+    std::string oversubscribed = { 1, 0x40 | 63, 0x40 | 63, 0x40 | 63, 0x40 | 62 };
+    EXPECT_EQ(CodeTable::deserialize(oversubscribed.data(), oversubscribed.size(), table), 0);
+    EXPECT_TRUE(table.empty());
+}
+
+// Test that bytes outside the sample are refused unless the table covers every byte
+TEST(CodeTableTest, CoverAllBytes) {
+    std::string sample = "aaaabbbc";
+    std::string message = "abcz";
+
+    CodeTable narrow = CodeTable::train(sample.data(), sample.size());
+    std::string encoded;
+    EXPECT_FALSE(narrow.can_encode(message.data(), message.size()));
+    EXPECT_FALSE(narrow.encode(message.data(), message.size(), encoded));
+    EXPECT_TRUE(encoded.empty());
+
+    CodeTable wide = CodeTable::train(sample.data(), sample.size(), max_code_length, true);
+    ASSERT_TRUE(wide.encode(message.data(), message.size(), encoded));
+    std::string decoded;
+    ASSERT_TRUE(wide.decode(encoded.data(), encoded.size(), decoded));
+    EXPECT_EQ(decoded, message);
+    EXPECT_LT(wide.get_code_lengths()['a'], wide.get_code_lengths()['z']);
+}
+
+// Test that histograms of several samples merge into one table
+TEST(CodeTableTest, TrainOnMergedHistograms) {
+    std::string first = "aaaa";
+    std::string second = "bbbbbbbb";
+    FrequencyTable frequency_table = count_frequencies(first.data(), first.size());
+    merge_frequencies(frequency_table, count_frequencies(second.data(), second.size()));
+    EXPECT_EQ(frequency_table['a'], 4);
+    EXPECT_EQ(frequency_table['b'], 8);
+
+    CodeTable table = CodeTable::train(frequency_table);
+    EXPECT_TRUE(table.can_encode("abba", 4));
+    EXPECT_FALSE(table.can_encode("abc", 3));
+}
+
+// Test that a Huffman instance built from a loaded table decodes blocks of the trained one
+TEST(CodeTableTest, HuffmanFromTable) {
+    std::string text = "the quick brown fox jumps over the lazy dog";
+    Huffman trained(text);
+    std::string encoded = trained.encode(text);
+
+    CodeTable loaded;
+    std::string bytes = trained.get_code_table().serialize();
+    ASSERT_NE(CodeTable::deserialize(bytes.data(), bytes.size(), loaded), 0);
+    Huffman reused(loaded);
+    EXPECT_EQ(reused.decode(encoded), text);
+    EXPECT_EQ(reused.encode(text), encoded);
+}
+
+// Test that a message with a corrupted trailer or stray bits is rejected
+TEST(CodeTableTest, DecodeRejectsMalformed) {
+    CodeTable table = CodeTable::train("abcd", 4);
+    std::string encoded;
+    ASSERT_TRUE(table.encode("abcdabcd", 8, encoded));
+
+    std::string decoded;
+    EXPECT_FALSE(table.decode(encoded.data(), 0, decoded));
+    encoded.back() = 9;
+    EXPECT_FALSE(table.decode(encoded.data(), encoded.size(), decoded));
+    encoded.back() = 1;
+    EXPECT_FALSE(table.decode(encoded.data(), encoded.size(), decoded));
+}
@@ -0,0 +1,126 @@
+#include "../../../include/DecodeTable.h"
+#include "../../../include/Huffman.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string pack(const std::vector<PrefixCode>& codes,
+                 const std::vector<std::uint32_t>& symbols,
+                 std::uint64_t& bit_count) {
+    std::string packed;
+    BitWriter writer(packed);
+    bit_count = 0;
+    for (std::uint32_t symbol : symbols) {
+        writer.write(codes[symbol].code, codes[symbol].length);
+        bit_count += codes[symbol].length;
+    }
+    writer.finish();
+    return packed;
+}
+
+/* symbol i gets the code 1...10 of length i + 1, the last one is all ones */
+std::vector<PrefixCode> unary_codes(unsigned count) {
+    std::vector<PrefixCode> codes;
+    for (unsigned i = 0; i < count; ++i) {
+        unsigned length = i + 1 < count ? i + 1 : i;
+        std::uint64_t ones = (std::uint64_t{ 1 } << length) - 1;
+        std::uint64_t code = i + 1 < count ? ones - 1 : ones;
+        codes.push_back(PrefixCode{ i, code, length });
+    }
+    return codes;
+}
+
+}   // namespace
+
+// Test that an empty code set decodes nothing
+TEST(DecodeTableTest, EmptyTable) {
+    DecodeTable table;
+    EXPECT_TRUE(table.empty());
+
+    std::string out;
+    BitReader reader("", 0, 0);
+    table.decode(reader, out);
+    EXPECT_TRUE(out.empty());
+}
+
+// Test that short codes resolve from the root table alone
+TEST(DecodeTableTest, ShortCodesUseRootOnly) {
+    std::vector<PrefixCode> codes = unary_codes(4);
+    DecodeTable table(codes);
+    EXPECT_EQ(table.size(), std::size_t{ 1 } << DecodeTable::root_bits);
+
+    std::vector<std::uint32_t> symbols = { 0, 1, 2, 3, 3, 2, 1, 0 };
+    std::uint64_t bit_count;
+    std::string packed = pack(codes, symbols, bit_count);
+
+    std::string out;
+    BitReader reader(packed.data(), packed.size(), bit_count);
+    table.decode(reader, out);
+    ASSERT_EQ(out.size(), symbols.size());
+    for (std::size_t i = 0; i < symbols.size(); ++i) {
+        EXPECT_EQ(static_cast<unsigned char>(out[i]), symbols[i]);
+    }
+}
+
+// Test that codes longer than the root width go through subtables
+TEST(DecodeTableTest, LongCodesUseSubtables) {
+    std::vector<PrefixCode> codes = unary_codes(40);
+    DecodeTable table(codes);
+    EXPECT_GT(table.size(), std::size_t{ 1 } << DecodeTable::root_bits);
+
+    std::vector<std::uint32_t> symbols;
+    for (std::uint32_t i = 0; i < 40; ++i) {
+        symbols.push_back(39 - i);
+        symbols.push_back(i % 3);
+    }
+    std::uint64_t bit_count;
+    std::string packed = pack(codes, symbols, bit_count);
+
+    std::string out;
+    BitReader reader(packed.data(), packed.size(), bit_count);
+    table.decode(reader, out);
+    ASSERT_EQ(out.size(), symbols.size());
+    for (std::size_t i = 0; i < symbols.size(); ++i) {
+        EXPECT_EQ(static_cast<unsigned char>(out[i]), symbols[i]);
+    }
+}
+
+// Test that decoding stops at a bit pattern that is not a code
+TEST(DecodeTableTest, StopsAtInvalidCode) {
+    DecodeTable table({ PrefixCode{ 'a', 0b0, 1 } });
+
+    std::string packed;
+    BitWriter writer(packed);
+    writer.write(0b001, 3);
+    writer.finish();
+
+    std::string out;
+    BitReader reader(packed.data(), packed.size(), 3);
+    table.decode(reader, out);
+    EXPECT_EQ(out, "aa");
+}
+
+// Test a Huffman round trip over a skewed input producing codes deeper than the root table
+TEST(DecodeTableTest, SkewedHuffmanRoundTrip) {
+    std::string text;
+    long long previous = 1;
+    long long current = 1;
+    for (int symbol = 0; symbol < 20; ++symbol) {
+        text += std::string(current, static_cast<char>('A' + symbol));
+        long long next = previous + current;
+        previous = current;
+        current = next;
+    }
+
+    Huffman huffman(text);
+    std::size_t longest = 0;
+    for (const auto& [symbol, code] : huffman.get_encoding_table()) {
+        longest = std::max(longest, code.size());
+    }
+    EXPECT_GT(longest, DecodeTable::root_bits);
+
+    std::string encoded = huffman.encode(text);
+    EXPECT_EQ(huffman.decode(encoded), text);
+}
@@ -11,8 +11,10 @@ TEST(BuildHuffmanTree, BasicEncodingWithInternalNodes) {
     ASSERT_EQ(encoding_table["b"].length(), 2);
     ASSERT_EQ(encoding_table["c"].length(), 2);
 
-    // Ensure internal nodes exist in the tree (root should not have a symbol)
-    ASSERT_EQ(huffman.huffman_tree->value.str, "abc");   // Root contains all characters combined
+    // Ensure internal nodes exist in the tree (root covers every occurrence)
+    ASSERT_EQ(huffman.huffman_tree.size(), 5);
+    ASSERT_FALSE(huffman.huffman_tree.root().is_leaf());
+    ASSERT_EQ(huffman.huffman_tree.root().freq, 6);
 }
 
 // Test with a single character (internal nodes won't be created here)
@@ -35,8 +37,10 @@ TEST(BuildHuffmanTree, AllUniqueCharacters) {
         ASSERT_TRUE(encoding_table.find(std::string(1, ch)) != encoding_table.end());
     }
 
-    // Verify internal nodes contain merged symbols
-    ASSERT_EQ(huffman.huffman_tree->value.str, "abcdef");
+    // Verify internal nodes merge every leaf
+    ASSERT_EQ(huffman.huffman_tree.leaves(), 6);
+    ASSERT_EQ(huffman.huffman_tree.size(), 11);
+    ASSERT_EQ(huffman.huffman_tree.root().freq, 6);
 }
 
 // Test with an empty string (no nodes created)
@@ -46,7 +50,7 @@ TEST(BuildHuffmanTree, EmptyInputWithInternalNodes) {
 
     // Expecting no encodings for an empty input
     ASSERT_TRUE(encoding_table.empty());
-    ASSERT_EQ(huffman.huffman_tree, nullptr);
+    ASSERT_TRUE(huffman.huffman_tree.empty());
 }
 
 // Test with repeated characters only (no internal nodes created)
@@ -69,7 +73,8 @@ TEST(BuildHuffmanTree, SpecialCharactersWithInternalNodes) {
     ASSERT_TRUE(encoding_table.find(" ") != encoding_table.end());
 
     // Verify internal nodes exist
-    ASSERT_EQ(huffman.huffman_tree->value.str, " abc");
+    ASSERT_EQ(huffman.huffman_tree.size(), 7);
+    ASSERT_EQ(huffman.huffman_tree.root().freq, 7);
 }
 
 // Test for case sensitivity (internal nodes should merge all characters)
@@ -82,8 +87,8 @@ TEST(BuildHuffmanTree, CaseSensitivityWithInternalNodes) {
     ASSERT_TRUE(encoding_table.find("a") != encoding_table.end());
     ASSERT_TRUE(encoding_table.find("A") != encoding_table.end());
 
-    // Verify internal nodes hold all characters
-    ASSERT_EQ(huffman.huffman_tree->value.str, "ABCabc");
+    // Verify leaves are kept apart by case
+    ASSERT_EQ(huffman.huffman_tree.leaves(), 6);
 }
 
 // Test with a long input string where internal nodes are expected
@@ -107,7 +112,7 @@ TEST(BuildHuffmanTree, ConsistencyTestWithInternalNodes) {
 
     // Encodings should be consistent between identical inputs
     ASSERT_EQ(encoding_table1, encoding_table2);
-    ASSERT_EQ(huffman1.huffman_tree->value.str, huffman2.huffman_tree->value.str);
+    ASSERT_EQ(huffman1.get_code_lengths(), huffman2.get_code_lengths());
 }
 
 // Test for correct ordering by frequency (with internal nodes)
@@ -120,6 +125,38 @@ TEST(BuildHuffmanTree, FrequencyOrderingTestWithInternalNodes) {
     ASSERT_EQ(frequency_table['b'], 2);
     ASSERT_EQ(frequency_table['c'], 1);
 
-    // Ensure root internal node contains all characters combined
-    ASSERT_EQ(huffman.huffman_tree->value.str, "abc");
+    // Ensure root internal node accounts for all characters combined
+    ASSERT_EQ(huffman.huffman_tree.root().freq, 6);
+}
+
+// Test that children always precede their parent in the arena
+TEST(BuildHuffmanTree, ArenaIsTopologicallyOrdered) {
+    Huffman huffman("the quick brown fox jumps over the lazy dog");
+    const HuffmanTree& tree = huffman.huffman_tree;
+
+    for (std::size_t i = tree.leaves(); i < tree.size(); ++i) {
+        ASSERT_LT(tree[i].left, static_cast<std::int16_t>(i));
+        ASSERT_LT(tree[i].right, static_cast<std::int16_t>(i));
+        ASSERT_EQ(tree[i].freq, tree[tree[i].left].freq + tree[tree[i].right].freq);
+    }
+}
+
+// Test that equal frequencies are broken by symbol value
+TEST(BuildHuffmanTree, TiesBrokenBySymbol) {
+    FrequencyTable frequency_table{};
+    frequency_table['d'] = 1;
+    frequency_table['c'] = 1;
+    frequency_table['b'] = 1;
+    frequency_table['a'] = 1;
+    frequency_table['e'] = 1;
+
+    HuffmanTree tree(frequency_table);
+    CodeLengths lengths = tree.code_lengths();
+
+    // the two smallest symbols are merged first and end up one level deeper
+    EXPECT_EQ(lengths['a'], 3);
+    EXPECT_EQ(lengths['b'], 3);
+    EXPECT_EQ(lengths['c'], 2);
+    EXPECT_EQ(lengths['d'], 2);
+    EXPECT_EQ(lengths['e'], 2);
 }
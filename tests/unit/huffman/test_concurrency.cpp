@@ -0,0 +1,77 @@
+#include "../../../include/Huffman.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr unsigned thread_count = 8;
+constexpr unsigned rounds = 200;
+
+std::string message(unsigned thread, unsigned round) {
+    std::string text;
+    for (unsigned i = 0; i < 20 + round % 50; ++i) {
+        text += "request " + std::to_string(thread * 1000 + round + i) + " ok; ";
+    }
+    return text;
+}
+
+}   // namespace
+
+// Test one shared instance encoding and decoding from many threads at once (run under HUFFMAN_SANITIZE_THREAD)
+TEST(ConcurrencyTest, SharedInstanceStress) {
+    auto huffman = std::make_shared<const Huffman>(message(0, 0) + "0123456789");
+    std::string foreign_text = "zzzz yyyy xxxx";
+    std::string foreign = Huffman(foreign_text).encode(foreign_text);
+
+    std::atomic<unsigned> failures{ 0 };
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<std::byte> packed;
+            std::vector<std::byte> unpacked;
+            for (unsigned round = 0; round < rounds; ++round) {
+                std::string text = message(t, round);
+                if (huffman->decode(huffman->encode(text)) != text) {
+                    ++failures;
+                }
+
+                packed.resize(huffman->max_encoded_size(text.size()));
+                unpacked.resize(text.size());
+                std::size_t packed_size = 0;
+                std::size_t unpacked_size = 0;
+                bool ok = huffman->encode(std::as_bytes(std::span(text.data(), text.size())), packed, packed_size) &&
+                          huffman->decode(std::span<const std::byte>(packed.data(), packed_size), unpacked, unpacked_size);
+                if (!ok || std::string(reinterpret_cast<const char*>(unpacked.data()), unpacked_size) != text) {
+                    ++failures;
+                }
+
+                /* the path that builds a private table for another header */
+                if (huffman->decode(foreign) != foreign_text) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(failures.load(), 0u);
+}
+
+// Test that instances built from get_tables() share the tables and produce the same output
+TEST(ConcurrencyTest, SharedTables) {
+    std::string text = message(3, 7);
+    Huffman trained(text);
+    Huffman shared(trained.get_tables());
+
+    EXPECT_EQ(shared.get_tables().get(), trained.get_tables().get());
+    EXPECT_EQ(shared.encode(text), trained.encode(text));
+    EXPECT_EQ(shared.decode(trained.encode(text)), text);
+
+    Huffman copy = trained;
+    EXPECT_EQ(copy.get_tables().get(), trained.get_tables().get());
+}
@@ -1,7 +1,6 @@
 #include "../../../include/Huffman.h"
 #include <gtest/gtest.h>
 #include <string>
-#include <unordered_map>
 
 // Test for basic frequency table creation
 TEST(FrequencyTableTest, BasicFrequencyTest) {
@@ -21,7 +20,7 @@ TEST(FrequencyTableTest, EmptyStringTest) {
     auto frequency_table = huffman.get_frequency_table();
 
     // An empty string should result in an empty frequency table
-    EXPECT_TRUE(frequency_table.empty());
+    EXPECT_EQ(count_symbols(frequency_table), 0);
 }
 
 // Test for a string with repeating characters
@@ -31,7 +30,7 @@ TEST(FrequencyTableTest, RepeatingCharactersTest) {
 
     // Only one unique character with a frequency of 3
     EXPECT_EQ(frequency_table['a'], 3);
-    EXPECT_EQ(frequency_table.size(), 1);
+    EXPECT_EQ(count_symbols(frequency_table), 1);
 }
 
 // Test for a string containing spaces and special characters
@@ -58,5 +57,29 @@ TEST(FrequencyTableTest, UniqueCharactersTest) {
     EXPECT_EQ(frequency_table['1'], 1);
     EXPECT_EQ(frequency_table['2'], 1);
     EXPECT_EQ(frequency_table['3'], 1);
-    EXPECT_EQ(frequency_table.size(), 6);   // All characters are unique
+    EXPECT_EQ(count_symbols(frequency_table), 6);   // All characters are unique
+}
+
+// Test that bytes above 0x7F are counted under their unsigned value
+TEST(FrequencyTableTest, HighBytesTest) {
+    Huffman huffman("\xff\x80\xff");
+    auto frequency_table = huffman.get_frequency_table();
+
+    EXPECT_EQ(frequency_table[0xFF], 2);
+    EXPECT_EQ(frequency_table[0x80], 1);
+    EXPECT_EQ(count_symbols(frequency_table), 2);
+}
+
+// Test that the interleaved counting matches a plain per-byte count across word boundaries
+TEST(FrequencyTableTest, InterleavedMatchesScalar) {
+    std::string text;
+    for (int i = 0; i < 1003; ++i) {
+        text += static_cast<char>(i % 7 == 0 ? 'x' : (i * 31) % 256);
+    }
+
+    FrequencyTable expected{};
+    for (char ch : text) {
+        expected[static_cast<unsigned char>(ch)]++;
+    }
+    EXPECT_EQ(count_frequencies(text.data(), text.size()), expected);
 }
@@ -1,6 +1,8 @@
 #include "../../../include/Huffman.h"
 #include <gtest/gtest.h>
+#include <span>
 #include <string>
+#include <vector>
 
 // Test encoding with an empty string
 TEST(EmptyStringEncoding, EncodeString) {
@@ -14,7 +16,7 @@ TEST(EmptyStringEncoding, EncodeString) {
 TEST(SimpleStringEncoding, EncodeSimpleString) {
     std::string text = "aaaa";
     Huffman huffman(text);
-    std::string encoded = huffman.encode(text);
+    std::string encoded = huffman.encode_bit_string(text);
     std::string expected =
         huffman.get_encoding_table().at("a") + huffman.get_encoding_table().at("a") +
         huffman.get_encoding_table().at("a") + huffman.get_encoding_table().at("a");
@@ -42,7 +44,7 @@ TEST(EncodingDecodingConsistency, EncodeDecodeConsistency) {
 TEST(SingleCharacterString, EncodeSingleCharacter) {
     std::string text = "a";
     Huffman huffman(text);
-    std::string encoded = huffman.encode(text);
+    std::string encoded = huffman.encode_bit_string(text);
     EXPECT_EQ(encoded.length(), huffman.get_encoding_table().at("a").length());
 }
 
@@ -71,3 +73,70 @@ TEST(AllUniqueCharacters, EncodeDecodeUnique) {
     std::string decoded = huffman.decode(encoded);
     EXPECT_EQ(decoded, text);
 }
+
+// Test that the packed output is smaller than the input and round-trips
+TEST(PackedEncoding, PackedOutputIsCompressed) {
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "the quick brown fox jumps over the lazy dog ";
+    }
+    Huffman huffman(text);
+    std::string encoded = huffman.encode(text);
+    EXPECT_LT(encoded.size(), text.size());
+
+    std::string header;
+    write_code_lengths(huffman.get_code_lengths(), header);
+    std::string bits = huffman.encode_bit_string(text);
+    EXPECT_EQ(encoded.size(), header.size() + 1 + (bits.size() + 7) / 8 + 1);
+    EXPECT_EQ(huffman.decode(encoded), text);
+}
+
+// Test that the trailer keeps a partially filled last byte intact
+TEST(PackedEncoding, PartialLastByteRoundTrip) {
+    for (std::size_t length = 1; length <= 40; ++length) {
+        std::string text;
+        for (std::size_t i = 0; i < length; ++i) {
+            text += static_cast<char>('a' + i % 5);
+        }
+        Huffman huffman(text);
+        std::string encoded = huffman.encode(text);
+        EXPECT_EQ(huffman.decode(encoded), text) << "length " << length;
+    }
+}
+
+// Test that a stream whose trailer no longer matches its bits decodes to nothing, not to what was read
+TEST(PackedEncoding, RejectsDamagedTrailer) {
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "the quick brown fox jumps over the lazy dog ";
+    }
+    Huffman huffman(text);
+    std::string encoded = huffman.encode(text);
+    ASSERT_EQ(huffman.decode(encoded), text);
+
+    std::uint8_t last_byte_bits = static_cast<unsigned char>(encoded.back());
+    ASSERT_GT(last_byte_bits, 1);
+    encoded.back() = static_cast<char>(last_byte_bits - 1);
+    EXPECT_EQ(huffman.decode(encoded), "");
+}
+
+// Test that the debug bit string view still round-trips
+TEST(BitStringEncoding, DebugViewRoundTrip) {
+    std::string text = "debug view";
+    Huffman huffman(text);
+    std::string bits = huffman.encode_bit_string(text);
+    EXPECT_EQ(bits.find_first_not_of("01"), std::string::npos);
+    EXPECT_EQ(huffman.decode_bit_string(bits), text);
+}
+
+// Test that a byte the training text lacked is refused by both encode overloads instead of dropped
+TEST(PackedEncoding, RejectsUntrainedByte) {
+    Huffman huffman(std::string("abcabcabd"));
+    std::string text = "abcxabc";
+    EXPECT_EQ(huffman.encode(text), "");
+
+    std::vector<std::byte> out(huffman.max_encoded_size(text.size()));
+    std::size_t written = 0;
+    EXPECT_FALSE(huffman.encode(std::as_bytes(std::span(text)), out, written));
+    EXPECT_EQ(huffman.decode(huffman.encode(std::string("abcdabc"))), "abcdabc");
+}
@@ -0,0 +1,119 @@
+#include "../../../include/Huffman.h"
+#include "../../../include/PackageMerge.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+
+FrequencyTable fibonacci_frequencies(std::size_t symbols) {
+    FrequencyTable frequency_table{};
+    std::uint64_t previous = 1;
+    std::uint64_t current = 1;
+    for (std::size_t symbol = 0; symbol < symbols; ++symbol) {
+        frequency_table[symbol] = current;
+        std::uint64_t next = previous + current;
+        previous = current;
+        current = next;
+    }
+    return frequency_table;
+}
+
+std::uint64_t coded_bits(const FrequencyTable& frequency_table, const CodeLengths& lengths) {
+    std::uint64_t bits = 0;
+    for (std::size_t symbol = 0; symbol < frequency_table.size(); ++symbol) {
+        bits += frequency_table[symbol] * lengths[symbol];
+    }
+    return bits;
+}
+
+unsigned longest(const CodeLengths& lengths) {
+    return *std::max_element(lengths.begin(), lengths.end());
+}
+
+}   // namespace
+
+// Test that skewed distributions exceed every practical limit without package-merge
+TEST(LengthLimitTest, UnlimitedTreeGrowsDeep) {
+    HuffmanTree tree(fibonacci_frequencies(40));
+    EXPECT_EQ(longest(tree.code_lengths()), 39);
+}
+
+// Test that the limited lengths respect the bound and still form a complete prefix code
+TEST(LengthLimitTest, RespectsLimit) {
+    FrequencyTable frequency_table = fibonacci_frequencies(40);
+    for (unsigned limit : { 6u, 11u, 12u, 15u }) {
+        CodeLengths lengths = package_merge_code_lengths(frequency_table, limit);
+        EXPECT_EQ(longest(lengths), limit);
+        EXPECT_TRUE(is_valid_code_lengths(lengths));
+        EXPECT_EQ(count_symbols(frequency_table), 40);
+        for (std::size_t symbol = 0; symbol < 40; ++symbol) {
+            EXPECT_GT(lengths[symbol], 0);
+        }
+    }
+}
+
+// Test that a non-binding limit gives the same cost as the unlimited tree
+TEST(LengthLimitTest, NonBindingLimitIsOptimal) {
+    std::string text = "the quick brown fox jumps over the lazy dog";
+    FrequencyTable frequency_table = count_frequencies(text.data(), text.size());
+    CodeLengths unlimited = HuffmanTree(frequency_table).code_lengths();
+
+    CodeLengths limited = package_merge_code_lengths(frequency_table, 15);
+    EXPECT_EQ(coded_bits(frequency_table, limited), coded_bits(frequency_table, unlimited));
+}
+
+// Test the compression loss of tighter limits against the unlimited tree
+TEST(LengthLimitTest, CompressionLossIsSmall) {
+    FrequencyTable frequency_table = fibonacci_frequencies(30);
+    std::uint64_t unlimited = coded_bits(frequency_table, HuffmanTree(frequency_table).code_lengths());
+
+    std::uint64_t previous = unlimited;
+    for (unsigned limit : { 15u, 12u, 11u }) {
+        std::uint64_t limited = coded_bits(frequency_table, package_merge_code_lengths(frequency_table, limit));
+        EXPECT_GE(limited, previous);
+        EXPECT_LT(limited, unlimited + unlimited / 100);
+        previous = limited;
+    }
+}
+
+// Test that a limit below log2 of the alphabet is raised to the smallest feasible one
+TEST(LengthLimitTest, LimitRaisedToFeasible) {
+    FrequencyTable frequency_table{};
+    for (std::size_t symbol = 0; symbol < 256; ++symbol) {
+        frequency_table[symbol] = symbol + 1;
+    }
+    CodeLengths lengths = package_merge_code_lengths(frequency_table, 4);
+    for (std::uint8_t length : lengths) {
+        EXPECT_EQ(length, 8);
+    }
+}
+
+// Test a limited Huffman instance end to end
+TEST(LengthLimitTest, LimitedHuffmanRoundTrip) {
+    std::string text;
+    FrequencyTable frequency_table = fibonacci_frequencies(22);
+    for (std::size_t symbol = 0; symbol < 22; ++symbol) {
+        text += std::string(frequency_table[symbol], static_cast<char>('A' + symbol));
+    }
+
+    Huffman unlimited(text);
+    EXPECT_GT(longest(unlimited.get_code_lengths()), 12);
+
+    Huffman limited(text, 12);
+    EXPECT_EQ(longest(limited.get_code_lengths()), 12);
+
+    std::string encoded = limited.encode(text);
+    EXPECT_EQ(limited.decode(encoded), text);
+    EXPECT_EQ(unlimited.decode(encoded), text);
+}
+
+// Test that the default limit keeps extreme distributions within the bit buffer width
+TEST(LengthLimitTest, DefaultLimitCapsAtMaxCodeLength) {
+    FrequencyTable frequency_table = fibonacci_frequencies(80);
+    CodeLengths unlimited = HuffmanTree(frequency_table).code_lengths();
+    EXPECT_GT(longest(unlimited), max_code_length);
+
+    CodeLengths limited = limit_code_lengths(frequency_table, unlimited, max_code_length);
+    EXPECT_EQ(longest(limited), max_code_length);
+    EXPECT_TRUE(is_valid_code_lengths(limited));
+}
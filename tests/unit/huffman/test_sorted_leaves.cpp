@@ -0,0 +1,117 @@
+#include "../../../include/Huffman.h"
+#include <gtest/gtest.h>
+#include <string>
+
+// Test for basic leaf ordering
+TEST(SortedLeavesTest, BasicFunctionality) {
+    Huffman huffman("aabbc");
+    const HuffmanTree& tree = huffman.huffman_tree;
+
+    // Check the number of leaves (3 unique characters: a, b, c)
+    EXPECT_EQ(tree.leaves(), 3);
+
+    // Verify the leaf with the lowest frequency comes first ('c' with frequency 1)
+    EXPECT_EQ(tree[0].symbol, 'c');
+    EXPECT_EQ(tree[0].freq, 1);
+}
+
+// Test for an empty input
+TEST(SortedLeavesTest, EmptyInputTest) {
+    Huffman huffman("");
+
+    // There should be no leaves for an empty input
+    EXPECT_EQ(huffman.huffman_tree.leaves(), 0);
+}
+
+// Test for a single character input
+TEST(SortedLeavesTest, SingleCharacterInput) {
+    Huffman huffman("aaaa");
+    const HuffmanTree& tree = huffman.huffman_tree;
+
+    // Should contain only one leaf under a root
+    EXPECT_EQ(tree.leaves(), 1);
+    EXPECT_EQ(tree.size(), 2);
+    EXPECT_EQ(tree[0].symbol, 'a');
+    EXPECT_EQ(tree[0].freq, 4);
+}
+
+// Test for multiple characters with the same frequency
+TEST(SortedLeavesTest, EqualFrequencyTest) {
+    Huffman huffman("cab");
+    const HuffmanTree& tree = huffman.huffman_tree;
+
+    // All characters should have frequency 1 and be ordered by symbol
+    EXPECT_EQ(tree.leaves(), 3);
+    for (std::size_t i = 0; i < tree.leaves(); ++i) {
+        EXPECT_EQ(tree[i].freq, 1);
+        EXPECT_EQ(tree[i].symbol, 'a' + i);
+    }
+}
+
+// Test for correct ordering with different frequencies
+TEST(SortedLeavesTest, OrderingTest) {
+    Huffman huffman("aaaabbc");
+    const HuffmanTree& tree = huffman.huffman_tree;
+
+    // The lowest frequency should come first ('c' with frequency 1)
+    EXPECT_EQ(tree[0].symbol, 'c');
+    EXPECT_EQ(tree[0].freq, 1);
+}
+
+// Test for walking every leaf in order
+TEST(SortedLeavesTest, WalkLeavesTest) {
+    Huffman huffman("aaabbc");
+    const HuffmanTree& tree = huffman.huffman_tree;
+    ASSERT_EQ(tree.leaves(), 3);
+
+    // The first leaf should be 'c' with frequency 1
+    EXPECT_EQ(tree[0].symbol, 'c');
+    EXPECT_EQ(tree[0].freq, 1);
+
+    // The second leaf should be 'b' with frequency 2
+    EXPECT_EQ(tree[1].symbol, 'b');
+    EXPECT_EQ(tree[1].freq, 2);
+
+    // The third leaf should be 'a' with frequency 3
+    EXPECT_EQ(tree[2].symbol, 'a');
+    EXPECT_EQ(tree[2].freq, 3);
+}
+
+// Test for building a tree directly from a frequency table
+TEST(SortedLeavesTest, DirectConstructionTest) {
+    FrequencyTable frequency_table{};
+    frequency_table['a'] = 5;
+    frequency_table['b'] = 2;
+    frequency_table['c'] = 3;
+    HuffmanTree tree(frequency_table);
+
+    // Expect the element with the lowest frequency first ('b')
+    EXPECT_EQ(tree[0].symbol, 'b');
+    EXPECT_EQ(tree[0].freq, 2);
+    EXPECT_EQ(tree.root().freq, 10);
+}
+
+// Test for a larger number of elements
+TEST(SortedLeavesTest, LargeInputTest) {
+    Huffman huffman("aaaaaaaaaabbbbccccdd");
+    const HuffmanTree& tree = huffman.huffman_tree;
+
+    // Four unique elements: a, b, c, d
+    EXPECT_EQ(tree.leaves(), 4);
+
+    // Verify the smallest frequency leaf ('d' with frequency 2)
+    EXPECT_EQ(tree[0].symbol, 'd');
+    EXPECT_EQ(tree[0].freq, 2);
+}
+
+// Test for leaves with special characters
+TEST(SortedLeavesTest, SpecialCharactersTest) {
+    Huffman huffman("a b c a");
+    const HuffmanTree& tree = huffman.huffman_tree;
+
+    // Four unique leaves including space character
+    EXPECT_EQ(tree.leaves(), 4);
+
+    // The first leaf should have the smallest frequency
+    EXPECT_EQ(tree[0].freq, 1);
+}
@@ -0,0 +1,140 @@
+#include "../../../include/BasicHuffman.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+/* Zipf-like tokens spread over the whole range of the symbol type */
+template <typename Symbol>
+std::vector<Symbol> token_text(std::size_t count, unsigned distinct, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<Symbol> vocabulary;
+    for (unsigned i = 0; i < distinct; ++i) {
+        vocabulary.push_back(static_cast<Symbol>(rng()));
+    }
+    std::vector<double> weights;
+    for (unsigned i = 0; i < distinct; ++i) {
+        weights.push_back(1.0 / (i + 1));
+    }
+    std::discrete_distribution<unsigned> pick(weights.begin(), weights.end());
+
+    std::vector<Symbol> text;
+    for (std::size_t i = 0; i < count; ++i) {
+        text.push_back(vocabulary[pick(rng)]);
+    }
+    return text;
+}
+
+template <typename Symbol>
+class SymbolTypeTest : public ::testing::Test {};
+
+using SymbolTypes = ::testing::Types<std::uint8_t, std::uint16_t, std::uint32_t>;
+TYPED_TEST_SUITE(SymbolTypeTest, SymbolTypes);
+
+}   // namespace
+
+// Test round trips and that Zipf-distributed tokens compress below their fixed width
+TYPED_TEST(SymbolTypeTest, RoundTrip) {
+    std::vector<TypeParam> text = token_text<TypeParam>(20000, 200, 1);
+    BasicHuffman<TypeParam> huffman(text);
+    std::string encoded = huffman.encode(text);
+    EXPECT_LT(encoded.size(), text.size() * sizeof(TypeParam));
+    EXPECT_EQ(huffman.decode(encoded), text);
+}
+
+// Test empty and single-symbol inputs
+TYPED_TEST(SymbolTypeTest, DegenerateInputs) {
+    std::vector<TypeParam> empty;
+    BasicHuffman<TypeParam> none(empty);
+    EXPECT_EQ(none.encode(empty), "");
+    EXPECT_TRUE(none.decode(std::string()).empty());
+
+    std::vector<TypeParam> single(100, std::numeric_limits<TypeParam>::max());
+    BasicHuffman<TypeParam> huffman(single);
+    EXPECT_EQ(huffman.get_code_length(single[0]), 1);
+    EXPECT_EQ(huffman.get_frequency(single[0]), 100);
+    EXPECT_EQ(huffman.decode(huffman.encode(single)), single);
+}
+
+// Test that output carries its own table and decodes with any instance
+TYPED_TEST(SymbolTypeTest, ForeignTable) {
+    std::vector<TypeParam> first = token_text<TypeParam>(5000, 50, 2);
+    std::vector<TypeParam> second = token_text<TypeParam>(5000, 70, 3);
+    BasicHuffman<TypeParam> trained(first);
+    BasicHuffman<TypeParam> other(second);
+    EXPECT_EQ(other.decode(trained.encode(first)), first);
+}
+
+// Test that symbols unseen in training are refused and that nothing is appended then
+TYPED_TEST(SymbolTypeTest, UnknownSymbol) {
+    std::vector<TypeParam> text = { 1, 2, 3, 1 };
+    BasicHuffman<TypeParam> huffman(text);
+    std::vector<TypeParam> unknown = { 1, 4 };
+    std::string out = "x";
+    EXPECT_FALSE(huffman.encode(unknown.data(), unknown.size(), out));
+    EXPECT_EQ(out, "x");
+}
+
+// Test that a code length limit bounds every code
+TYPED_TEST(SymbolTypeTest, LengthLimit) {
+    std::vector<TypeParam> text;
+    std::uint64_t run = 1;
+    for (TypeParam symbol = 0; symbol < 30; ++symbol) {
+        text.insert(text.end(), run, symbol);
+        run = std::min<std::uint64_t>(run * 3 / 2 + 1, 4000);
+    }
+    BasicHuffman<TypeParam> huffman(text, 8);
+    for (std::uint8_t length : huffman.get_code_lengths()) {
+        EXPECT_LE(length, 8);
+    }
+    EXPECT_EQ(huffman.decode(huffman.encode(text)), text);
+}
+
+// Test that truncated or inconsistent input is rejected
+TYPED_TEST(SymbolTypeTest, RejectsMalformed) {
+    std::vector<TypeParam> text = token_text<TypeParam>(1000, 20, 4);
+    BasicHuffman<TypeParam> huffman(text);
+    std::string encoded = huffman.encode(text);
+    std::vector<TypeParam> out;
+
+    EXPECT_FALSE(huffman.decode(encoded.data(), encoded.size() - 1, out) && out == text);
+    out.clear();
+    std::string bad_count = encoded;
+    bad_count[0] = static_cast<char>(0xFF);
+    EXPECT_FALSE(huffman.decode(bad_count.data(), bad_count.size(), out) && out == text);
+}
+
+// Test that 16-bit alphabets use the full symbol range and the wide alphabet works sparsely
+TEST(SymbolTypeWideTest, FullRange) {
+    std::vector<std::uint16_t> tokens;
+    for (std::uint32_t token = 0; token < 65536; token += 7) {
+        tokens.push_back(static_cast<std::uint16_t>(token));
+        tokens.push_back(static_cast<std::uint16_t>(token));
+    }
+    Huffman16 huffman16(tokens);
+    EXPECT_EQ(huffman16.get_symbols().size(), 9363);
+    EXPECT_EQ(huffman16.decode(huffman16.encode(tokens)), tokens);
+
+    std::vector<std::uint32_t> wide = { 0, 0xFFFFFFFF, 0x80000000, 0xFFFFFFFF };
+    Huffman32 huffman32(wide);
+    EXPECT_EQ(huffman32.get_symbols(), (std::vector<std::uint32_t>{ 0, 0x80000000, 0xFFFFFFFF }));
+    EXPECT_EQ(huffman32.decode(huffman32.encode(wide)), wide);
+}
+
+// Test that the generic merge gives the byte tree's depths
+TEST(SymbolTypeWideTest, DepthsMatchByteTree) {
+    std::mt19937 rng(5);
+    FrequencyTable frequency_table{};
+    for (std::size_t symbol = 0; symbol < 256; symbol += 3) {
+        frequency_table[symbol] = rng() % 1000 + 1;
+    }
+
+    std::vector<std::uint64_t> weights(frequency_table.begin(), frequency_table.end());
+    std::vector<std::uint32_t> depths = huffman_code_depths(weights);
+    CodeLengths lengths = HuffmanTree(frequency_table).code_lengths();
+    for (std::size_t symbol = 0; symbol < 256; ++symbol) {
+        EXPECT_EQ(depths[symbol], lengths[symbol]) << symbol;
+    }
+}
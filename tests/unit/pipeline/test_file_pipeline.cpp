@@ -0,0 +1,133 @@
+#include "../../../include/FilePipeline.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+/* writes `text` to a temporary file, runs the pipeline into another and returns what it wrote */
+bool compress_through_files(FilePipeline& pipeline, const std::string& text, std::string& encoded) {
+    FILE* in = std::tmpfile();
+    FILE* out = std::tmpfile();
+    if (!in || !out) {
+        return false;
+    }
+    std::fwrite(text.data(), 1, text.size(), in);
+    std::fflush(in);
+
+    bool ok = pipeline.compress(fileno(in), fileno(out));
+    encoded.clear();
+    if (ok) {
+        std::rewind(out);
+        char buffer[4096];
+        std::size_t got;
+        while ((got = std::fread(buffer, 1, sizeof(buffer), out)) > 0) {
+            encoded.append(buffer, got);
+        }
+    }
+    std::fclose(in);
+    std::fclose(out);
+    return ok;
+}
+
+}   // namespace
+
+// Test that both I/O backends write exactly the container BlockCodec builds in memory
+TEST(FilePipelineTest, MatchesInMemoryContainer) {
+    for (IoBackend backend : { IoBackend::threads, IoBackend::io_uring }) {
+        for (unsigned in_flight : { 1u, 2u, 5u }) {
+            for (std::size_t size : { 0, 1, 4096, 50000 }) {
+                std::string text = word_text(size, 24);
+                BlockOptions block{ 4096, 2 };
+                FilePipeline pipeline({ block, in_flight, backend });
+
+                std::string encoded;
+                ASSERT_TRUE(compress_through_files(pipeline, text, encoded)) << pipeline.get_backend();
+                EXPECT_EQ(encoded, BlockCodec(block).encode(text))
+                    << pipeline.get_backend() << ", " << in_flight << " in flight, size " << size;
+                EXPECT_EQ(pipeline.get_raw_size(), size);
+                EXPECT_EQ(pipeline.get_encoded_size(), encoded.size());
+            }
+        }
+    }
+}
+
+// Test that the thread fallback is used when asked for, and the result decodes
+TEST(FilePipelineTest, ThreadFallbackRoundTrip) {
+    std::string text = word_text(300000, 24);
+    FilePipeline pipeline({ { 1 << 14, 4 }, 0, IoBackend::threads });
+
+    std::string encoded;
+    ASSERT_TRUE(compress_through_files(pipeline, text, encoded));
+    EXPECT_STREQ(pipeline.get_backend(), "pread");
+
+    BlockCodec codec;
+    EXPECT_TRUE(codec.verify(encoded));
+    EXPECT_EQ(codec.decode(encoded), text);
+}
+
+// Test that in-flight memory is bounded by the slot count, not the file size
+TEST(FilePipelineTest, MemoryCeiling) {
+    FilePipeline narrow({ { 1 << 16, 1 }, 2 });
+    FilePipeline wide({ { 1 << 16, 1 }, 8 });
+    EXPECT_EQ(wide.memory_ceiling(), 4 * narrow.memory_ceiling());
+    EXPECT_LT(narrow.memory_ceiling(), std::size_t{ 1 } << 20);
+}
+
+// Test that inputs other than regular files are refused
+TEST(FilePipelineTest, RejectsPipes) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    FILE* out = std::tmpfile();
+
+    FilePipeline pipeline;
+    EXPECT_FALSE(pipeline.compress(fds[0], fileno(out)));
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+    std::fclose(out);
+}
+
+// Test that the container is written from the given offset, leaving what precedes it alone
+TEST(FilePipelineTest, WritesAfterExistingContent) {
+    std::string text = word_text(20000, 24);
+    std::string prefix = "prefix\n";
+    FILE* in = std::tmpfile();
+    FILE* out = std::tmpfile();
+    ASSERT_TRUE(in && out);
+    std::fwrite(text.data(), 1, text.size(), in);
+    std::fwrite(prefix.data(), 1, prefix.size(), out);
+    std::fflush(in);
+    std::fflush(out);
+
+    BlockOptions block{ 4096, 2 };
+    FilePipeline pipeline({ block, 3 });
+    ASSERT_TRUE(pipeline.compress(fileno(in), fileno(out), prefix.size()));
+
+    std::string written;
+    std::rewind(out);
+    char buffer[4096];
+    std::size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), out)) > 0) {
+        written.append(buffer, got);
+    }
+    EXPECT_EQ(written, prefix + BlockCodec(block).encode(text));
+    std::fclose(in);
+    std::fclose(out);
+}
+
+// Test that an output opened for append is refused, positioned writes would be reordered there
+TEST(FilePipelineTest, RejectsAppendOutput) {
+    FILE* in = std::tmpfile();
+    FILE* out = std::tmpfile();
+    ASSERT_TRUE(in && out);
+    std::fputs("some input", in);
+    std::fflush(in);
+    ASSERT_EQ(::fcntl(fileno(out), F_SETFL, O_APPEND), 0);
+
+    FilePipeline pipeline;
+    EXPECT_FALSE(pipeline.compress(fileno(in), fileno(out)));
+    std::fclose(in);
+    std::fclose(out);
+}
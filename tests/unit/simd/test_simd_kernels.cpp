@@ -0,0 +1,109 @@
+#include "../../../include/Block.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+
+const SimdLevel all_levels[] = { SimdLevel::scalar, SimdLevel::sse42, SimdLevel::avx2 };
+
+/* lengths growing with the symbol, the longest `longest` bits long */
+CodeLengths staircase_lengths(unsigned longest) {
+    CodeLengths lengths{};
+    for (unsigned symbol = 0; symbol < longest; ++symbol) {
+        lengths[symbol] = static_cast<std::uint8_t>(symbol + 1);
+    }
+    lengths[longest] = static_cast<std::uint8_t>(longest);
+    return lengths;
+}
+
+std::string pack(const FlatEncodeTable& table, const std::string& text, SimdLevel level) {
+    std::string out;
+    BitWriter writer(out);
+    pack_symbols(table, text.data(), text.size(), writer, level);
+    out.push_back(static_cast<char>(writer.finish()));
+    return out;
+}
+
+std::string pack_scalar(const EncodeTable& table, const std::string& text) {
+    std::string out;
+    BitWriter writer(out);
+    pack_symbols_scalar(table, text.data(), text.size(), writer);
+    out.push_back(static_cast<char>(writer.finish()));
+    return out;
+}
+
+}   // namespace
+
+// Test that every histogram kernel agrees with the scalar reference, whatever the length and alignment
+TEST(SimdKernelTest, HistogramMatchesScalar) {
+    std::string text = random_text(5000, 256, 1) + std::string(300, 'r') + random_text(700, 3, 2);
+    for (std::size_t offset : { 0, 1, 7, 31 }) {
+        for (std::size_t size : { 0, 1, 15, 16, 17, 32, 33, 100, 4000, 5900 }) {
+            FrequencyTable expected = count_frequencies_scalar(text.data() + offset, size);
+            for (SimdLevel level : all_levels) {
+                EXPECT_EQ(count_frequencies(text.data() + offset, size, level), expected)
+                    << "level " << static_cast<int>(level) << ", offset " << offset << ", size " << size;
+            }
+        }
+    }
+}
+
+// Test that a run of one byte is counted correctly by the whole-vector shortcut
+TEST(SimdKernelTest, HistogramOfRun) {
+    std::string text(1000, '\xff');
+    for (SimdLevel level : all_levels) {
+        FrequencyTable frequency_table = count_frequencies(text.data(), text.size(), level);
+        EXPECT_EQ(frequency_table[0xff], 1000);
+        EXPECT_EQ(count_symbols(frequency_table), 1);
+    }
+}
+
+// Test that every packing kernel writes the same bits as the scalar reference for short, medium and long codes
+TEST(SimdKernelTest, PackingMatchesScalar) {
+    for (unsigned longest : { 8, 16, 17, 32, 33, 56 }) {
+        EncodeTable table = make_encode_table(staircase_lengths(longest));
+        FlatEncodeTable flat(table);
+        ASSERT_TRUE(is_valid_code_lengths(staircase_lengths(longest)));
+
+        for (std::size_t size : { 0, 3, 63, 64, 65, 66, 67, 1001 }) {
+            std::string text = random_text(size, longest + 1, longest);
+            std::string expected = pack_scalar(table, text);
+            for (SimdLevel level : all_levels) {
+                EXPECT_EQ(pack(flat, text, level), expected)
+                    << "level " << static_cast<int>(level) << ", longest " << longest << ", size " << size;
+            }
+        }
+    }
+}
+
+// Test that the flat-table packer merges codes into the same bits as the scalar reference
+TEST(SimdKernelTest, FlatPackingMatchesScalar) {
+    for (unsigned longest : { 8, 16, 17, 32, 33, 56 }) {
+        EncodeTable table = make_encode_table(staircase_lengths(longest));
+        FlatEncodeTable flat(table);
+        EXPECT_EQ(flat.longest(), longest);
+
+        for (std::size_t size : { 0, 1, 2, 3, 4, 5, 7, 1001 }) {
+            std::string text = random_text(size, longest + 1, longest + 100);
+            std::string out;
+            BitWriter writer(out);
+            pack_symbols_flat(flat, text.data(), text.size(), writer);
+            out.push_back(static_cast<char>(writer.finish()));
+            EXPECT_EQ(out, pack_scalar(table, text)) << "longest " << longest << ", size " << size;
+        }
+    }
+}
+
+// Test that the kernels reached through the detected level round-trip through a block
+TEST(SimdKernelTest, DetectedLevelRoundTrip) {
+    EXPECT_EQ(usable_simd_level(SimdLevel::avx2), detected_simd_level());
+    EXPECT_EQ(usable_simd_level(SimdLevel::scalar), SimdLevel::scalar);
+
+    std::string text = random_text(100000, 40, 3);
+    std::string block;
+    encode_block(text.data(), text.size(), block, max_code_length, 4);
+    std::string decoded(text.size(), '\0');
+    ASSERT_TRUE(decode_block(block.data(), block.size(), decoded.data(), decoded.size()));
+    EXPECT_EQ(decoded, text);
+}
@@ -0,0 +1,88 @@
+#include "../../../include/Huffman.h"
+#include "../../../include/SpanCodec.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::span<const std::byte> bytes_of(const std::string& text) {
+    return std::as_bytes(std::span(text.data(), text.size()));
+}
+
+std::string text_of(const std::vector<std::byte>& buffer, std::size_t size) {
+    return std::string(reinterpret_cast<const char*>(buffer.data()), size);
+}
+
+}   // namespace
+
+// Test compress/decompress between fixed buffers for coded, stored, run and empty inputs
+TEST(SpanApiTest, CompressRoundTrip) {
+    std::string random = random_text(3000, 256, 3);
+    for (const std::string& text : { random_text(10000, 5, 11, 'a'), random, std::string(4000, 'z'), std::string() }) {
+        std::vector<std::byte> compressed(max_compressed_size(text.size()));
+        std::size_t compressed_size = 0;
+        ASSERT_TRUE(compress(bytes_of(text), compressed, compressed_size));
+        EXPECT_LE(compressed_size, compressed.size());
+
+        std::span<const std::byte> packed(compressed.data(), compressed_size);
+        std::uint64_t raw_size = 0;
+        ASSERT_TRUE(decompressed_size(packed, raw_size));
+        EXPECT_EQ(raw_size, text.size());
+
+        std::vector<std::byte> decompressed(raw_size);
+        std::size_t written = 0;
+        ASSERT_TRUE(decompress(packed, decompressed, written));
+        EXPECT_EQ(text_of(decompressed, written), text);
+    }
+}
+
+// Test that undersized output buffers are refused
+TEST(SpanApiTest, RefusesShortBuffers) {
+    std::string text = random_text(1000, 4, 11, 'a');
+    std::vector<std::byte> compressed(max_compressed_size(text.size()) - 1);
+    std::size_t written = 0;
+    EXPECT_FALSE(compress(bytes_of(text), compressed, written));
+
+    compressed.resize(max_compressed_size(text.size()));
+    ASSERT_TRUE(compress(bytes_of(text), compressed, written));
+    std::vector<std::byte> decompressed(text.size() - 1);
+    std::size_t decoded = 0;
+    EXPECT_FALSE(decompress(std::span(compressed.data(), written), decompressed, decoded));
+}
+
+// Test that Huffman's span overloads produce and accept exactly the string format
+TEST(SpanApiTest, HuffmanOverloadsMatchStrings) {
+    std::string text = "span overloads write into caller-owned memory";
+    Huffman huffman(text);
+    std::string expected = huffman.encode(text);
+
+    std::vector<std::byte> out(huffman.max_encoded_size(text.size()));
+    std::size_t written = 0;
+    ASSERT_TRUE(huffman.encode(bytes_of(text), out, written));
+    EXPECT_EQ(text_of(out, written), expected);
+
+    std::vector<std::byte> decoded(text.size());
+    std::size_t decoded_size = 0;
+    ASSERT_TRUE(huffman.decode(std::span<const std::byte>(out.data(), written), decoded, decoded_size));
+    EXPECT_EQ(text_of(decoded, decoded_size), text);
+
+    std::vector<std::byte> short_out(decoded.size() - 1);
+    EXPECT_FALSE(huffman.decode(std::span<const std::byte>(out.data(), written), short_out, decoded_size));
+}
+
+// Test that the Huffman bound holds for any text the table codes, and that too small buffers fail
+TEST(SpanApiTest, HuffmanBound) {
+    Huffman huffman(std::string(1000, 'a') + "bcdefgh");
+    std::string worst(500, 'h');
+
+    std::vector<std::byte> out(huffman.max_encoded_size(worst.size()));
+    std::size_t written = 0;
+    ASSERT_TRUE(huffman.encode(bytes_of(worst), out, written));
+    EXPECT_LE(written, out.size());
+
+    out.resize(written - 1);
+    EXPECT_FALSE(huffman.encode(bytes_of(worst), out, written));
+    EXPECT_FALSE(huffman.encode(bytes_of(std::string("xyz")), out, written));
+}
@@ -0,0 +1,169 @@
+#include "../../../include/CodeTable.h"
+#include "../../../include/StaticHuffman.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+namespace {
+
+/* lowercase letters, space and newline with rough English frequencies */
+struct TextProfile {
+    static constexpr FrequencyTable frequencies = [] {
+        FrequencyTable table{};
+        constexpr std::uint64_t letters[26] = { 82, 15, 28, 43, 127, 22, 20, 61, 70, 2,  8,  40, 24,
+                                                67, 75, 19, 1,  60, 63, 91, 28, 10, 24, 2,  20, 1 };
+        for (int i = 0; i < 26; ++i) {
+            table['a' + i] = letters[i];
+        }
+        table[' '] = 180;
+        table['\n'] = 10;
+        return table;
+    }();
+};
+
+/* every byte present with steeply falling frequencies: unlimited codes would be far longer than 8 bits */
+struct SkewedProfile {
+    static constexpr FrequencyTable frequencies = [] {
+        FrequencyTable table{};
+        std::uint64_t a = 1;
+        std::uint64_t b = 1;
+        for (int i = 0; i < 256; ++i) {
+            table[255 - i] = i < 60 ? b : 1;
+            if (i < 60) {
+                std::uint64_t c = a + b;
+                a = b;
+                b = c;
+            }
+        }
+        return table;
+    }();
+    static constexpr unsigned code_length_limit = 8;
+};
+
+struct SingleSymbolProfile {
+    static constexpr FrequencyTable frequencies = [] {
+        FrequencyTable table{};
+        table['x'] = 5;
+        return table;
+    }();
+};
+
+using TextHuffman = StaticHuffman<TextProfile>;
+
+/* the tables must be usable in constant expressions */
+static_assert(TextHuffman::code_lengths[' '] > 0);
+static_assert(TextHuffman::code_lengths['A'] == 0);
+static_assert(TextHuffman::code_lengths[' '] <= TextHuffman::code_lengths['q']);
+static_assert(TextHuffman::max_encoded_size(0) == 1);
+
+std::string profile_text(std::size_t size) {
+    std::mt19937 rng(23);
+    std::string text;
+    while (text.size() < size) {
+        text += "the quick brown fox jumps over the lazy dog";
+        text.push_back(rng() % 4 ? ' ' : '\n');
+    }
+    text.resize(size);
+    return text;
+}
+
+template <typename Profile>
+void expect_matches_runtime_tables() {
+    using Static = StaticHuffman<Profile>;
+    EXPECT_TRUE(is_valid_code_lengths(Static::code_lengths));
+
+    EncodeTable runtime = make_encode_table(Static::code_lengths);
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        EXPECT_EQ(Static::encode_table[symbol].length, runtime[symbol].length) << symbol;
+        if (runtime[symbol].length) {
+            EXPECT_EQ(Static::encode_table[symbol].code, runtime[symbol].code) << symbol;
+        }
+    }
+}
+
+}   // namespace
+
+// Test that the compile-time canonical codes are the ones the runtime builds from the same lengths
+TEST(StaticHuffmanTest, MatchesRuntimeTables) {
+    expect_matches_runtime_tables<TextProfile>();
+    expect_matches_runtime_tables<SkewedProfile>();
+    expect_matches_runtime_tables<SingleSymbolProfile>();
+}
+
+// Test that the compile-time lengths are as short as the runtime Huffman code when no limit binds
+TEST(StaticHuffmanTest, OptimalWithoutLimit) {
+    CodeLengths runtime = train_code_lengths(TextProfile::frequencies, max_code_length);
+    auto cost = [](const CodeLengths& lengths) {
+        std::uint64_t bits = 0;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            bits += TextProfile::frequencies[symbol] * lengths[symbol];
+        }
+        return bits;
+    };
+    EXPECT_EQ(cost(TextHuffman::code_lengths), cost(runtime));
+}
+
+// Test that the length limit holds for a profile whose plain Huffman code is much deeper
+TEST(StaticHuffmanTest, LengthLimit) {
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        EXPECT_GE(StaticHuffman<SkewedProfile>::code_lengths[symbol], 1);
+        EXPECT_LE(StaticHuffman<SkewedProfile>::code_lengths[symbol], 8);
+    }
+
+    std::string text;
+    for (int i = 0; i < 5000; ++i) {
+        text.push_back(static_cast<char>(i * 7));
+    }
+    std::string encoded = StaticHuffman<SkewedProfile>::encode(text);
+    std::string decoded;
+    ASSERT_TRUE(StaticHuffman<SkewedProfile>::decode(encoded.data(), encoded.size(), decoded));
+    EXPECT_EQ(decoded, text);
+}
+
+// Test round trips, and that messages interoperate with a CodeTable of the same lengths
+TEST(StaticHuffmanTest, RoundTripAndCodeTableInterop) {
+    CodeTable table(TextHuffman::code_lengths);
+    for (std::size_t size : { 0, 1, 3, 4, 5, 100, 10000 }) {
+        std::string text = profile_text(size);
+        std::string encoded = TextHuffman::encode(text);
+        ASSERT_FALSE(encoded.empty());
+        EXPECT_LE(encoded.size(), TextHuffman::max_encoded_size(size));
+
+        std::string decoded;
+        ASSERT_TRUE(TextHuffman::decode(encoded.data(), encoded.size(), decoded));
+        EXPECT_EQ(decoded, text);
+
+        std::string from_table;
+        ASSERT_TRUE(table.encode(text.data(), text.size(), from_table));
+        EXPECT_EQ(from_table, encoded);
+
+        std::string buffer(size, '\0');
+        std::size_t written = 0;
+        EXPECT_TRUE(TextHuffman::decode(encoded.data(), encoded.size(), buffer.data(), buffer.size(), written));
+        EXPECT_EQ(written, size);
+    }
+}
+
+// Test that bytes outside the profile and malformed messages are refused
+TEST(StaticHuffmanTest, RejectsUnknownInput) {
+    EXPECT_EQ(TextHuffman::encode("Capital"), "");
+
+    std::string encoded = TextHuffman::encode(profile_text(100));
+    std::string decoded;
+    EXPECT_FALSE(TextHuffman::decode(encoded.data(), 0, decoded));
+
+    std::string small(10, '\0');
+    std::size_t written = 0;
+    EXPECT_FALSE(TextHuffman::decode(encoded.data(), encoded.size(), small.data(), small.size(), written));
+}
+
+// Test the one-symbol profile, which still needs a one-bit code
+TEST(StaticHuffmanTest, SingleSymbol) {
+    using Single = StaticHuffman<SingleSymbolProfile>;
+    EXPECT_EQ(Single::code_lengths['x'], 1);
+
+    std::string encoded = Single::encode("xxxxxxxxxx");
+    std::string decoded;
+    ASSERT_TRUE(Single::decode(encoded.data(), encoded.size(), decoded));
+    EXPECT_EQ(decoded, "xxxxxxxxxx");
+}
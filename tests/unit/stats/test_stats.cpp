@@ -0,0 +1,99 @@
+#include "../../../include/Huffman.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+std::string sample_text() {
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        text += "the quick brown fox " + std::to_string(i % 37) + "\n";
+    }
+    return text;
+}
+
+}   // namespace
+
+// Test that the enabled recorder accumulates every counter
+TEST(StatsTest, RecorderCounts) {
+    BasicStatsRecorder<true> recorder;
+    {
+        BasicStatsRecorder<true>::Timer timer(recorder, Stage::encode);
+    }
+    recorder.add_time(Stage::tree, 250);
+    recorder.add_encoded(1000, 600);
+    recorder.add_encoded(10, 8);
+    recorder.add_decoded(1010);
+    recorder.add_table();
+    recorder.add_table_miss();
+    recorder.set_code_quality(4.5, 4.25);
+
+    HuffmanStats stats = recorder.snapshot();
+    EXPECT_EQ(stats.tree_ns, 250u);
+    EXPECT_EQ(stats.bytes_in, 1010u);
+    EXPECT_EQ(stats.bytes_out, 608u);
+    EXPECT_EQ(stats.bytes_decoded, 1010u);
+    EXPECT_EQ(stats.tables_built, 1u);
+    EXPECT_EQ(stats.decode_table_misses, 1u);
+    EXPECT_DOUBLE_EQ(stats.average_code_length, 4.5);
+
+    BasicStatsRecorder<true> copy = recorder;
+    EXPECT_EQ(copy.snapshot().bytes_in, 1010u);
+
+    recorder.reset();
+    EXPECT_EQ(recorder.snapshot().bytes_in, 0u);
+    EXPECT_DOUBLE_EQ(recorder.snapshot().entropy, 4.25);
+}
+
+// Test that the disabled recorder holds nothing and reports zeros
+TEST(StatsTest, DisabledRecorderIsEmpty) {
+    EXPECT_TRUE(std::is_empty_v<BasicStatsRecorder<false>>);
+
+    BasicStatsRecorder<false> recorder;
+    recorder.add_encoded(1000, 600);
+    EXPECT_EQ(recorder.snapshot().bytes_in, 0u);
+}
+
+// Test the JSON export
+TEST(StatsTest, JsonExport) {
+    HuffmanStats stats;
+    stats.bytes_in = 42;
+    stats.entropy = 1.5;
+    std::string json = stats.to_json();
+
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find("\"bytes_in\":42"), std::string::npos);
+    EXPECT_NE(json.find("\"entropy\":1.500000"), std::string::npos);
+    EXPECT_NE(json.find("\"decode_table_misses\":0"), std::string::npos);
+}
+
+// Test what a Huffman instance reports, depending on how the library was built
+TEST(StatsTest, HuffmanReportsStages) {
+    std::string text = sample_text();
+    Huffman huffman(text);
+    std::string encoded = huffman.encode(text);
+    ASSERT_EQ(huffman.decode(encoded), text);
+
+    std::string other_text = "a different alphabet entirely";
+    Huffman other(other_text);
+    std::string foreign = other.encode(other_text);
+    ASSERT_EQ(huffman.decode(foreign), other_text);
+
+    HuffmanStats stats = huffman.get_stats();
+    if constexpr (stats_enabled) {
+        EXPECT_EQ(stats.bytes_in, text.size());
+        EXPECT_EQ(stats.bytes_out, encoded.size());
+        EXPECT_EQ(stats.bytes_decoded, text.size() + other_text.size());
+        EXPECT_EQ(stats.tables_built, 2u);
+        EXPECT_EQ(stats.decode_table_misses, 1u);
+        EXPECT_GT(stats.encode_ns, 0u);
+        EXPECT_GE(stats.average_code_length, stats.entropy);
+        EXPECT_LT(stats.average_code_length, stats.entropy + 1);
+    } else {
+        EXPECT_EQ(stats.bytes_in, 0u);
+        EXPECT_EQ(stats.tables_built, 0u);
+        EXPECT_EQ(stats.average_code_length, 0);
+    }
+}
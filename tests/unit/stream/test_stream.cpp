@@ -0,0 +1,166 @@
+#include "../../../include/Stream.h"
+#include "../TestText.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+namespace {
+
+/* pushes `input` through `coder` in `chunk` sized pieces, checking the memory ceiling throughout */
+template <typename Coder>
+std::string run(Coder& coder, const std::string& input, std::size_t chunk) {
+    std::string output;
+    std::vector<char> buffer(chunk);
+    std::size_t pos = 0;
+    bool finished = false;
+
+    while (!coder.done()) {
+        if (pos < input.size()) {
+            pos += coder.write(input.data() + pos, std::min(chunk, input.size() - pos));
+        } else if (!finished) {
+            coder.finish();
+            finished = true;
+        }
+        EXPECT_LE(coder.buffered(), coder.memory_ceiling());
+
+        std::size_t produced = coder.read(buffer.data(), buffer.size());
+        output.append(buffer.data(), produced);
+
+        if constexpr (requires { coder.failed(); }) {
+            if (coder.failed()) {
+                break;
+            }
+        }
+    }
+    return output;
+}
+
+}   // namespace
+
+// Test an empty stream, which is just the end frame
+TEST(StreamTest, EmptyStream) {
+    StreamEncoder encoder;
+    std::string encoded = run(encoder, "", 16);
+    EXPECT_EQ(encoded.size(), frame_header_size);
+
+    StreamDecoder decoder;
+    EXPECT_EQ(run(decoder, encoded, 16), "");
+    EXPECT_FALSE(decoder.failed());
+}
+
+// Test round trips with odd chunk sizes and memory staying under the ceiling
+TEST(StreamTest, ChunkedRoundTripStaysBounded) {
+    std::string text = word_text(300000, 7);
+    StreamOptions options{ 4096 };
+
+    for (std::size_t chunk : { 1, 100, 4096, 65536 }) {
+        StreamEncoder encoder(options);
+        std::string encoded = run(encoder, text, chunk);
+        EXPECT_LT(encoded.size(), text.size());
+
+        StreamDecoder decoder(options);
+        EXPECT_EQ(run(decoder, encoded, chunk), text) << chunk;
+        EXPECT_FALSE(decoder.failed());
+    }
+}
+
+// Test that frames after the first mostly reuse its table and still decode
+TEST(StreamTest, FramesReuseTables) {
+    std::string text = word_text(100000, 7);
+    StreamEncoder encoder({ 4096 });
+    std::string encoded = run(encoder, text, 4096);
+
+    std::size_t frames = 0;
+    std::size_t repeats = 0;
+    for (std::size_t pos = 0; load_le32(encoded.data() + pos) != 0;) {
+        std::size_t encoded_size = load_le32(encoded.data() + pos + 4);
+        const char* block = encoded.data() + pos + frame_header_size;
+        repeats += block_kind(block, encoded_size) == BlockKind::repeat;
+        ++frames;
+        pos += frame_header_size + encoded_size;
+    }
+    EXPECT_GT(repeats, frames / 2);
+
+    StreamDecoder decoder({ 4096 });
+    EXPECT_EQ(run(decoder, encoded, 1000), text);
+    EXPECT_FALSE(decoder.failed());
+}
+
+// Test that a stream cut before its end frame fails
+TEST(StreamTest, TruncatedStreamFails) {
+    std::string text = word_text(10000, 7);
+    StreamEncoder encoder({ 1024 });
+    std::string encoded = run(encoder, text, 512);
+    encoded.resize(encoded.size() - 3);
+
+    std::istringstream in(encoded);
+    std::ostringstream out;
+    EXPECT_FALSE(decode_stream(in, out, { 1024 }));
+}
+
+// Test that a flipped bit inside a block fails the frame checksum
+TEST(StreamTest, CorruptedFrameFails) {
+    std::string text = word_text(10000, 7);
+    StreamEncoder encoder({ 1024 });
+    std::string encoded = run(encoder, text, 512);
+    encoded[frame_header_size + 100] ^= 0x10;
+
+    StreamDecoder decoder({ 1024 });
+    std::string decoded = run(decoder, encoded, 512);
+    EXPECT_TRUE(decoder.failed());
+    EXPECT_TRUE(decoded.empty());
+}
+
+// Test that frames larger than the decoder's block size are refused
+TEST(StreamTest, OversizedFrameRejected) {
+    std::string text = word_text(10000, 7);
+    StreamEncoder encoder({ 8192 });
+    std::string encoded = run(encoder, text, 512);
+
+    StreamDecoder decoder({ 1024 });
+    decoder.write(encoded.data(), encoded.size());
+    EXPECT_TRUE(decoder.failed());
+    EXPECT_LE(decoder.buffered(), decoder.memory_ceiling());
+}
+
+// Test the std::istream / std::ostream helpers
+TEST(StreamTest, IostreamRoundTrip) {
+    std::string text = word_text(100000, 7);
+
+    std::istringstream raw_in(text);
+    std::ostringstream encoded_out;
+    ASSERT_TRUE(encode_stream(raw_in, encoded_out, { 8192 }));
+
+    std::istringstream encoded_in(encoded_out.str());
+    std::ostringstream decoded_out;
+    ASSERT_TRUE(decode_stream(encoded_in, decoded_out, { 8192 }));
+    EXPECT_EQ(decoded_out.str(), text);
+}
+
+// Test the file descriptor helpers over temporary files
+TEST(StreamTest, FileDescriptorRoundTrip) {
+    std::string text = word_text(20000, 7);
+    FILE* raw = std::tmpfile();
+    FILE* encoded = std::tmpfile();
+    FILE* decoded = std::tmpfile();
+    ASSERT_TRUE(raw && encoded && decoded);
+
+    std::fwrite(text.data(), 1, text.size(), raw);
+    std::fflush(raw);
+    std::rewind(raw);
+
+    ASSERT_TRUE(encode_fd(fileno(raw), fileno(encoded), { 4096 }));
+    ::lseek(fileno(encoded), 0, SEEK_SET);
+    ASSERT_TRUE(decode_fd(fileno(encoded), fileno(decoded), { 4096 }));
+
+    ::lseek(fileno(decoded), 0, SEEK_SET);
+    std::string result(text.size() + 1, '\0');
+    ssize_t got = ::read(fileno(decoded), result.data(), result.size());
+    result.resize(got > 0 ? got : 0);
+    EXPECT_EQ(result, text);
+
+    std::fclose(raw);
+    std::fclose(encoded);
+    std::fclose(decoded);
+}
@@ -0,0 +1,62 @@
+#include "../../../include/ThreadPool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+// Test that every index runs exactly once
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndex) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> visits(1000);
+
+    pool.parallel_for(visits.size(), [&](std::size_t i) { visits[i]++; });
+
+    for (const auto& count : visits) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+// Test that a pool without threads runs tasks inline
+TEST(ThreadPoolTest, ZeroThreadsRunsInline) {
+    ThreadPool pool(0);
+    EXPECT_EQ(pool.size(), 0);
+
+    int sum = 0;
+    pool.parallel_for(10, [&](std::size_t i) { sum += static_cast<int>(i); });
+    EXPECT_EQ(sum, 45);
+}
+
+// Test that uneven task costs are spread over the workers
+TEST(ThreadPoolTest, UnevenWorkCompletes) {
+    ThreadPool pool(3);
+    std::atomic<long long> total{ 0 };
+
+    pool.parallel_for(64, [&](std::size_t i) {
+        long long local = 0;
+        for (std::size_t j = 0; j < (i % 4 == 0 ? 200000 : 10); ++j) {
+            local += j % 3;
+        }
+        total += local;
+    });
+    EXPECT_GT(total.load(), 0);
+}
+
+// Test that submitted tasks finish before the pool is destroyed
+TEST(ThreadPoolTest, DestructorDrainsQueue) {
+    std::atomic<int> done{ 0 };
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&] { done++; });
+        }
+    }
+    EXPECT_EQ(done.load(), 100);
+}
+
+// Test that parallel_for inside a task completes even when every worker is waiting on a nested loop
+TEST(ThreadPoolTest, NestedParallelFor) {
+    ThreadPool pool(2);
+    std::atomic<int> inner{ 0 };
+
+    pool.parallel_for(8, [&](std::size_t) { pool.parallel_for(16, [&](std::size_t) { inner++; }); });
+    EXPECT_EQ(inner.load(), 8 * 16);
+}